@@ -0,0 +1,66 @@
+#include "byte_stream.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t len = 1024 * 1024 * 1024;
+constexpr size_t capacity = 64000;
+constexpr size_t read_size = 1000;
+
+void main_loop(const ByteStream::Backend backend, const size_t write_size) {
+    ByteStream stream{capacity, backend};
+
+    string chunk(write_size, 'x');
+    for (auto &ch : chunk) {
+        ch = rand();
+    }
+
+    string output;
+    output.reserve(read_size);
+
+    size_t total_read = 0;
+    const auto first_time = high_resolution_clock::now();
+
+    while (total_read < len) {
+        // fill the stream with small writes
+        while (stream.remaining_capacity() >= write_size) {
+            stream.write(chunk);
+        }
+
+        // drain it in segment-sized reads
+        while (stream.buffer_size() >= read_size) {
+            stream.read(output, read_size);
+            total_read += output.size();
+        }
+    }
+
+    const auto final_time = high_resolution_clock::now();
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    const auto gigabits_per_second = total_read * 8.0 / double(duration);
+
+    cout << fixed << setprecision(2);
+    cout << (backend == ByteStream::Backend::Ring ? "Ring   " : "Chunked") << " backend, " << setw(4) << write_size
+         << "-byte writes: " << gigabits_per_second << " Gbit/s\n";
+}
+
+int main() {
+    try {
+        for (const size_t write_size : {16, 64, 256, 1460}) {
+            main_loop(ByteStream::Backend::Chunked, write_size);
+            main_loop(ByteStream::Backend::Ring, write_size);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
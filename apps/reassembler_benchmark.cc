@@ -0,0 +1,113 @@
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t len = 16 * 1024 * 1024;
+constexpr size_t capacity = 64000;
+
+//! A substring to push: its index and length
+using Piece = pair<size_t, size_t>;
+
+//! Segments of `size` bytes every `stride` bytes across [begin, end); overlapping if stride < size
+vector<Piece> tile(const size_t begin, const size_t end, const size_t size, const size_t stride) {
+    vector<Piece> ret;
+    for (size_t index = begin; index < end; index += stride) {
+        ret.emplace_back(index, min(size, end - index));
+    }
+    return ret;
+}
+
+//! In-order 1000-byte segments
+vector<Piece> in_order(const size_t begin, const size_t end, mt19937 &) { return tile(begin, end, 1000, 1000); }
+
+//! 1000-byte segments in random order
+vector<Piece> random_order(const size_t begin, const size_t end, mt19937 &rd) {
+    auto ret = tile(begin, end, 1000, 1000);
+    shuffle(ret.begin(), ret.end(), rd);
+    return ret;
+}
+
+//! Every other 8-byte piece first (leaving thousands of one-piece holes), then the rest in random order
+vector<Piece> tiny_holes(const size_t begin, const size_t end, mt19937 &rd) {
+    const auto pieces = tile(begin, end, 8, 8);
+    vector<Piece> ret, holes;
+    for (size_t i = 0; i < pieces.size(); i++) {
+        (i % 2 ? ret : holes).push_back(pieces[i]);
+    }
+    shuffle(holes.begin(), holes.end(), rd);
+    ret.insert(ret.end(), holes.begin(), holes.end());
+    return ret;
+}
+
+//! 4000-byte segments every 500 bytes (each byte arrives eight times), in random order
+vector<Piece> large_overlaps(const size_t begin, const size_t end, mt19937 &rd) {
+    auto ret = tile(begin, end, 4000, 500);
+    shuffle(ret.begin(), ret.end(), rd);
+    return ret;
+}
+
+void main_loop(const string &name, vector<Piece> (*pattern)(size_t, size_t, mt19937 &), const string &data) {
+    auto rd = get_random_generator();
+    StreamReassembler reassembler{capacity};
+    string output;
+    output.reserve(data.size());
+    size_t pushes = 0;
+
+    const auto first_time = high_resolution_clock::now();
+
+    for (size_t window_begin = 0; window_begin < data.size(); window_begin += capacity) {
+        const size_t window_end = min(window_begin + capacity, data.size());
+        for (const auto &[index, size] : pattern(window_begin, window_end, rd)) {
+            reassembler.push_substring(Buffer{data.substr(index, size)}, index, index + size == data.size());
+            pushes++;
+        }
+
+        const auto available = reassembler.stream_out().buffer_size();
+        output.append(reassembler.stream_out().read(available));
+    }
+
+    const auto final_time = high_resolution_clock::now();
+
+    if (output != data or not reassembler.stream_out().eof()) {
+        throw runtime_error(name + ": reassembled stream doesn't match");
+    }
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    const auto gigabits_per_second = data.size() * 8.0 / double(duration);
+    const auto nanoseconds_per_push = double(duration) / double(pushes);
+
+    cout << fixed << setprecision(2);
+    cout << "Reassembly, " << left << setw(15) << name << right << ": " << setw(6) << gigabits_per_second
+         << " Gbit/s, " << setw(8) << nanoseconds_per_push << " ns/push\n";
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        string data(len, 0);
+        generate(data.begin(), data.end(), [&] { return rd(); });
+
+        main_loop("in order", in_order, data);
+        main_loop("random order", random_order, data);
+        main_loop("tiny holes", tiny_holes, data);
+        main_loop("large overlaps", large_overlaps, data);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
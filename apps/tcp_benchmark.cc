@@ -1,35 +1,110 @@
 #include "tcp_connection.hh"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <random>
+#include <sstream>
 #include <string>
+#include <tuple>
 
 using namespace std;
 using namespace std::chrono;
 
 constexpr size_t len = 100 * 1024 * 1024;
 
-void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segments, const bool reorder) {
+//! number of heap allocations made so far (counted by the replacement operator new below)
+static size_t allocation_count = 0;
+
+void *operator new(size_t size) {
+    ++allocation_count;
+    if (void *ptr = malloc(size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+//! How the simulated path between the two connections behaves
+struct BenchmarkMode {
+    string name{};                   //!< printed after the throughput label
+    bool reorder = false;            //!< swap each adjacent pair of data segments (too little to look like loss)
+    bool wire = false;               //!< round-trip segments through their wire format
+    double loss_rate = 0;            //!< probability that a data-path segment is dropped
+    bool sack = true;                //!< let the connections negotiate SACK
+    bool rack_tlp = true;            //!< detect losses with RACK-TLP once SACK is negotiated
+    size_t ms_per_round_trip = 10;   //!< simulated time per exchange of segments (less than the RTO)
+    optional<size_t> mss{};          //!< MSS both connections give (if unset, TCPConfig::MAX_PAYLOAD_SIZE)
+    optional<uint16_t> ack_delay{};  //!< how long the connections may delay acks, in ms (if unset, they don't)
+    optional<size_t> write_size{};   //!< bytes per write, 16 writes a round trip (if unset, as many as fit)
+    TCPConfig::Nagle nagle = TCPConfig::Nagle::Off;  //!< the sender's variant of Nagle's algorithm
+    bool cork = false;                               //!< cork the sender around each round's writes
+    optional<size_t> read_size{};                    //!< bytes the receiver reads each round trip (if unset, all)
+};
+
+//! A long, thin path: a drop-tail queue in front of a slow bottleneck, then a long propagation delay
+struct EmulatedLink {
+    size_t bytes_per_ms = 100;     //!< bottleneck rate (800 kbit/s)
+    size_t queue_limit = 20000;    //!< bytes of payload the bottleneck can queue
+    uint64_t one_way_delay = 200;  //!< propagation delay each way, in ms
+    uint64_t duration = 60000;     //!< how long the sender keeps the link busy, in ms
+    double loss_rate = 0;          //!< chance a segment from the sender is lost before the queue (not to congestion)
+};
+
+void move_segments(TCPConnection &x,
+                   TCPConnection &y,
+                   vector<TCPSegment> &segments,
+                   const bool reorder,
+                   const bool wire,
+                   const double loss_rate = 0) {
+    static mt19937 loss_generator{1};
+    bernoulli_distribution loss{loss_rate};
+
     while (not x.segments_out().empty()) {
-        segments.emplace_back(move(x.segments_out().front()));
+        if (loss_rate > 0 and loss(loss_generator)) {
+            // dropped on the way
+        } else if (wire) {
+            // round-trip the segment through its wire format, as an adapter would
+            TCPSegment parsed;
+            if (parsed.parse(x.segments_out().front().serialize().concatenate()) != ParseResult::NoError) {
+                throw runtime_error("failed to parse serialized segment");
+            }
+            segments.emplace_back(move(parsed));
+        } else {
+            segments.emplace_back(move(x.segments_out().front()));
+        }
         x.segments_out().pop();
     }
     if (reorder) {
-        for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
-            y.segment_received(move(*it));
-        }
-    } else {
-        for (auto it = segments.begin(); it != segments.end(); ++it) {
-            y.segment_received(move(*it));
+        // each segment arrives at most one place late: fewer than the three duplicate acks that signal a loss
+        for (size_t i = 1; i < segments.size(); i += 2) {
+            swap(segments[i - 1], segments[i]);
         }
     }
+    for (auto &segment : segments) {
+        y.segment_received(move(segment));
+    }
     segments.clear();
 }
 
-void main_loop(const bool reorder) {
+void main_loop(const BenchmarkMode &mode) {
     TCPConfig config;
+    config.sack = mode.sack;
+    config.rack_tlp = mode.rack_tlp;
+    config.mss = mode.mss;
+    config.ack_delay = mode.ack_delay;
+    config.nagle = mode.nagle;
+    config.rto_min = TCPConfig::RTO_MIN_LAN;  // the simulated round trips are short; let the RTO follow them down
     TCPConnection x{config}, y{config};
 
     string string_to_send(len, 'x');
@@ -47,37 +122,56 @@ void main_loop(const bool reorder) {
     string_received.reserve(len);
 
     const auto first_time = high_resolution_clock::now();
+    const auto first_allocation_count = allocation_count;
+    size_t round_trips = 0;
+    size_t segments_sent = 0;
 
     auto loop = [&] {
         // write input into x
-        while (bytes_to_send.size() and x.remaining_outbound_capacity()) {
-            const auto want = min(x.remaining_outbound_capacity(), bytes_to_send.size());
-            const auto written = x.write(string(bytes_to_send.str().substr(0, want)));
+        if (mode.cork) {
+            x.cork();
+        }
+        // an application making small writes makes a few each round trip, rather than filling the buffer
+        const size_t writes_per_round_trip = mode.write_size.has_value() ? 16 : numeric_limits<size_t>::max();
+        for (size_t writes = 0;
+             writes < writes_per_round_trip and bytes_to_send.size() and x.remaining_outbound_capacity();
+             writes++) {
+            const auto want = min({x.remaining_outbound_capacity(),
+                                   bytes_to_send.size(),
+                                   mode.write_size.value_or(bytes_to_send.size())});
+            const auto written = x.write(bytes_to_send.slice(0, want));
             if (want != written) {
                 throw runtime_error("want = " + to_string(want) + ", written = " + to_string(written));
             }
             bytes_to_send.remove_prefix(written);
         }
+        if (mode.cork) {
+            x.uncork();
+        }
 
         if (bytes_to_send.size() == 0 and not x_closed) {
             x.end_input_stream();
             x_closed = true;
         }
 
-        // exchange segments between x and y but in reverse order
+        // exchange segments between x and y
         vector<TCPSegment> segments;
-        move_segments(x, y, segments, reorder);
-        move_segments(y, x, segments, false);
+        segments_sent += x.segments_out().size();
+        move_segments(x, y, segments, mode.reorder, mode.wire, mode.loss_rate);
+        move_segments(y, x, segments, false, mode.wire);
 
         // read output from y
-        const auto available_output = y.inbound_stream().buffer_size();
+        const auto available_output =
+            min(y.inbound_stream().buffer_size(), mode.read_size.value_or(numeric_limits<size_t>::max()));
         if (available_output > 0) {
             string_received.append(y.inbound_stream().read(available_output));
+            y.inbound_read();
         }
 
         // time passes
-        x.tick(1000);
-        y.tick(1000);
+        x.tick(mode.ms_per_round_trip);
+        y.tick(mode.ms_per_round_trip);
+        round_trips++;
     };
 
     while (not y.inbound_stream().eof()) {
@@ -89,24 +183,196 @@ void main_loop(const bool reorder) {
     }
 
     const auto final_time = high_resolution_clock::now();
+    const auto allocations = allocation_count - first_allocation_count;
 
     const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
 
     const auto gigabits_per_second = len * 8.0 / double(duration);
 
+    const auto allocations_per_megabyte = allocations * 1024.0 * 1024.0 / len;
+
     cout << fixed << setprecision(2);
-    cout << "CPU-limited throughput" << (reorder ? " with reordering: " : "                : ") << gigabits_per_second
-         << " Gbit/s\n";
+    cout << "CPU-limited throughput" << left << setw(32) << mode.name << right << ": " << setw(5)
+         << gigabits_per_second << " Gbit/s, " << setw(8) << allocations_per_megabyte << " allocations/MB";
+    if (mode.loss_rate > 0 or mode.read_size.has_value()) {
+        // with losses or a slow reader, what matters is how long the transfer takes in simulated time
+        const auto simulated_megabits_per_second = len * 8.0 / 1000.0 / double(round_trips * mode.ms_per_round_trip);
+        cout << ", " << setw(6) << simulated_megabits_per_second << " Mbit/s over " << mode.ms_per_round_trip
+             << " ms round trips, " << x.sender_stats().tlp_probes << " loss probes, "
+             << x.sender_stats().rack_losses << " RACK losses";
+    }
+    if (mode.write_size.has_value()) {
+        // with small writes, what matters is how many segments carry them
+        cout << ", " << setw(8) << segments_sent * 1024.0 * 1024.0 / len << " segments/MB";
+    }
+    cout << "\n";
 
     while (x.active() or y.active()) {
         loop();
     }
 }
 
+//! Send over an EmulatedLink for a fixed time, and report how soon (and how fully) the link is used
+void link_loop(const string &name, TCPConfig config, const EmulatedLink &link) {
+    config.initial_cwnd = 10 * config.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE);
+    TCPConnection x{config}, y{config};
+    x.connect();
+    y.end_input_stream();
+
+    mt19937 loss_generator{1};
+    bernoulli_distribution loss{link.loss_rate};
+
+    queue<TCPSegment> bottleneck;  // the drop-tail queue
+    size_t queued_bytes = 0;
+    size_t link_credit = 0;  // bytes the bottleneck may still send this ms
+    queue<pair<uint64_t, TCPSegment>> forward, reverse;  // propagating, with their arrival times
+
+    // bytes the bottleneck sends in each second
+    constexpr uint64_t bucket_ms = 1000;
+    vector<size_t> bytes_per_bucket(link.duration / bucket_ms);
+
+    bool x_closed = false;
+    uint64_t now = 0;
+    for (; x.active() or y.active(); ++now) {
+        if (now < link.duration) {
+            x.write(string(x.remaining_outbound_capacity(), 'x'));
+        } else if (not x_closed) {
+            x.end_input_stream();
+            x_closed = true;
+        }
+
+        while (not x.segments_out().empty()) {
+            TCPSegment &seg = x.segments_out().front();
+            if (link.loss_rate > 0 and loss(loss_generator)) {
+                // lost to noise on the way
+            } else if (queued_bytes + seg.payload().size() <= link.queue_limit) {
+                queued_bytes += seg.payload().size();
+                bottleneck.push(move(seg));
+            }
+            x.segments_out().pop();
+        }
+        link_credit = bottleneck.empty() ? 0 : link_credit + link.bytes_per_ms;
+        while (not bottleneck.empty() and bottleneck.front().payload().size() <= link_credit) {
+            const size_t size = bottleneck.front().payload().size();
+            link_credit -= size;
+            queued_bytes -= size;
+            if (now < link.duration) {
+                bytes_per_bucket.at(now / bucket_ms) += size;
+            }
+            forward.emplace(now + link.one_way_delay, move(bottleneck.front()));
+            bottleneck.pop();
+        }
+        while (not y.segments_out().empty()) {
+            reverse.emplace(now + link.one_way_delay, move(y.segments_out().front()));
+            y.segments_out().pop();
+        }
+
+        while (not forward.empty() and forward.front().first <= now) {
+            y.segment_received(move(forward.front().second));
+            forward.pop();
+        }
+        while (not reverse.empty() and reverse.front().first <= now) {
+            x.segment_received(move(reverse.front().second));
+            reverse.pop();
+        }
+        y.inbound_stream().pop_output(y.inbound_stream().buffer_size());
+
+        x.tick(1);
+        y.tick(1);
+    }
+
+    const size_t bucket_capacity = link.bytes_per_ms * bucket_ms;
+    const auto full = find_if(bytes_per_bucket.begin(), bytes_per_bucket.end(), [&](const size_t bytes) {
+        return bytes >= bucket_capacity * 9 / 10;
+    });
+    const auto bytes_sent = accumulate(bytes_per_bucket.begin(), bytes_per_bucket.end(), size_t{0});
+    const auto utilization = 100.0 * bytes_sent / (link.bytes_per_ms * link.duration);
+
+    ostringstream description;
+    description << fixed << setprecision(1) << 2 * link.one_way_delay << " ms, " << link.bytes_per_ms * 8 / 1000.0
+                << " Mbit/s link";
+    if (link.loss_rate > 0) {
+        description << " with " << setprecision(0) << link.loss_rate * 100 << "% loss";
+    }
+    description << " (" << name << ")";
+    cout << fixed << "Time to 90% of a " << left << setw(60) << description.str() << right << ": ";
+    if (full == bytes_per_bucket.end()) {
+        cout << "never";
+    } else {
+        cout << setw(5) << (full - bytes_per_bucket.begin() + 1) * bucket_ms / 1000 << " s";
+    }
+    cout << ", " << setprecision(2) << setw(6) << utilization << "% utilized over " << link.duration / 1000
+         << " s\n";
+}
+
+//! A configuration using `congestion_control`
+TCPConfig config_for(const TCPConfig::CongestionControl congestion_control) {
+    TCPConfig config;
+    config.congestion_control = congestion_control;
+    return config;
+}
+
 int main() {
     try {
-        main_loop(false);
-        main_loop(true);
+        main_loop({});
+        main_loop({" with reordering", true});
+        main_loop({" through serialize/parse", false, true});
+        main_loop({" with 2% loss", false, false, 0.02, true});
+        main_loop({" with 2% loss, without RACK-TLP", false, false, 0.02, true, false});
+        main_loop({" with 2% loss, without SACK", false, false, 0.02, false});
+        for (const size_t mss : {536, 1460, 8960}) {
+            BenchmarkMode mode{" with " + to_string(mss) + "-byte segments"};
+            mode.mss = mss;
+            main_loop(mode);
+        }
+        BenchmarkMode delayed_acks{" with delayed acks"};
+        delayed_acks.ack_delay = 40;
+        main_loop(delayed_acks);
+        for (const auto &[name, nagle, cork] : {make_tuple("", TCPConfig::Nagle::Off, false),
+                                                 make_tuple(", Nagle", TCPConfig::Nagle::On, false),
+                                                 make_tuple(", Minshall", TCPConfig::Nagle::Minshall, false),
+                                                 make_tuple(", corked", TCPConfig::Nagle::Off, true)}) {
+            BenchmarkMode mode{" with 100-byte writes" + string(name)};
+            mode.write_size = 100;
+            mode.nagle = nagle;
+            mode.cork = cork;
+            main_loop(mode);
+        }
+        BenchmarkMode slow_reader{" with a 1.6 Mbit/s reader"};
+        slow_reader.read_size = 2000;
+        main_loop(slow_reader);
+        TCPConfig unpaced_bbr = config_for(TCPConfig::CongestionControl::Bbr);
+        unpaced_bbr.pacing = false;
+        link_loop("NewReno", config_for(TCPConfig::CongestionControl::NewReno), {});
+        link_loop("CUBIC", config_for(TCPConfig::CongestionControl::Cubic), {});
+        link_loop("BBR", config_for(TCPConfig::CongestionControl::Bbr), {});
+        link_loop("BBR, unpaced", unpaced_bbr, {});
+        EmulatedLink lossy_link;
+        lossy_link.loss_rate = 0.01;
+        link_loop("NewReno", config_for(TCPConfig::CongestionControl::NewReno), lossy_link);
+        link_loop("CUBIC", config_for(TCPConfig::CongestionControl::Cubic), lossy_link);
+        link_loop("BBR", config_for(TCPConfig::CongestionControl::Bbr), lossy_link);
+        link_loop("BBR, unpaced", unpaced_bbr, lossy_link);
+        for (const size_t mss : {536, 1460}) {
+            TCPConfig config = config_for(TCPConfig::CongestionControl::NewReno);
+            config.mss = mss;
+            link_loop("NewReno, MSS " + to_string(mss), config, lossy_link);
+        }
+        TCPConfig delayed_acks_config = config_for(TCPConfig::CongestionControl::NewReno);
+        delayed_acks_config.ack_delay = 40;
+        link_loop("NewReno, delayed acks", delayed_acks_config, {});
+        link_loop("NewReno, delayed acks", delayed_acks_config, lossy_link);
+
+        // a long, fat path: a bandwidth-delay product of 625 kB, well past what an unscaled window covers
+        EmulatedLink fat_link;
+        fat_link.bytes_per_ms = 12500;
+        fat_link.queue_limit = 625000;
+        fat_link.one_way_delay = 25;
+        fat_link.duration = 10000;
+        TCPConfig big_buffers = config_for(TCPConfig::CongestionControl::Cubic);
+        big_buffers.recv_capacity = big_buffers.send_capacity = 4'000'000;
+        link_loop("CUBIC, 64 kB buffers", config_for(TCPConfig::CongestionControl::Cubic), fat_link);
+        link_loop("CUBIC, 4 MB buffers", big_buffers, fat_link);
     } catch (const exception &e) {
         cerr << e.what() << "\n";
         return EXIT_FAILURE;
@@ -13,6 +13,7 @@ add_test(NAME t_recv_window          COMMAND recv_window)
 add_test(NAME t_recv_reorder         COMMAND recv_reorder)
 add_test(NAME t_recv_close           COMMAND recv_close)
 add_test(NAME t_recv_special         COMMAND recv_special)
+add_test(NAME t_recv_sack            COMMAND recv_sack)
 
 add_test(NAME t_send_connect         COMMAND send_connect)
 add_test(NAME t_send_transmit        COMMAND send_transmit)
@@ -21,6 +22,14 @@ add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
 add_test(NAME t_send_extra           COMMAND send_extra)
+add_test(NAME t_send_sack            COMMAND send_sack)
+add_test(NAME t_send_congestion      COMMAND send_congestion)
+add_test(NAME t_send_cubic           COMMAND send_cubic)
+add_test(NAME t_send_bbr             COMMAND send_bbr)
+add_test(NAME t_send_rto             COMMAND send_rto)
+add_test(NAME t_send_dupack          COMMAND send_dupack)
+add_test(NAME t_send_rack            COMMAND send_rack)
+add_test(NAME t_send_pacing          COMMAND send_pacing)
 
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
 add_test(NAME t_strm_reassem_seq         COMMAND fsm_stream_reassembler_seq)
@@ -36,6 +45,9 @@ add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_buffer_pool              COMMAND buffer_pool)
+add_test(NAME t_small_vector             COMMAND small_vector)
+add_test(NAME t_buffer_prepend           COMMAND buffer_prepend)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -45,6 +57,7 @@ add_test(NAME router_test    COMMAND network_simulator)
 
 add_test(NAME t_tcp_parser           COMMAND tcp_parser "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
 add_test(NAME t_ipv4_parser          COMMAND ipv4_parser "${PROJECT_SOURCE_DIR}/tests/ipv4_parser.data")
+add_test(NAME t_tcp_options          COMMAND tcp_header_options)
 add_test(NAME t_active_close         COMMAND fsm_active_close)
 add_test(NAME t_passive_close        COMMAND fsm_passive_close)
 add_test(NAME ec_ack_rst             COMMAND fsm_ack_rst)
@@ -56,6 +69,13 @@ add_test(NAME t_connect              COMMAND fsm_connect_relaxed)
 add_test(NAME ec_listen              COMMAND fsm_listen)
 add_test(NAME t_listen               COMMAND fsm_listen_relaxed)
 add_test(NAME t_winsize              COMMAND fsm_winsize)
+add_test(NAME t_window_scale         COMMAND fsm_window_scale)
+add_test(NAME t_mss                  COMMAND fsm_mss)
+add_test(NAME t_timestamps           COMMAND fsm_timestamps)
+add_test(NAME t_delayed_ack          COMMAND fsm_delayed_ack)
+add_test(NAME t_nagle                COMMAND fsm_nagle)
+add_test(NAME t_window_update        COMMAND fsm_window_update)
+add_test(NAME t_persist              COMMAND fsm_persist)
 add_test(NAME ec_retx                COMMAND fsm_retx)
 add_test(NAME t_retx                 COMMAND fsm_retx_relaxed)
 add_test(NAME t_retx_win             COMMAND fsm_retx_win)
@@ -0,0 +1,265 @@
+#include "bbr_controller.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+//! \param[in] time is when the sample was taken
+//! \param[in] value is the sample
+void WindowedMaxFilter::update(const uint64_t time, const double value) {
+    const Sample sample{time, value};
+    if (value >= _samples[0].value or time - _samples[2].time > _window) {
+        _samples.fill(sample);  // a new best, or everything has aged out
+        return;
+    }
+    if (value >= _samples[1].value) {
+        _samples[2] = _samples[1] = sample;
+    } else if (value >= _samples[2].value) {
+        _samples[2] = sample;
+    }
+
+    // age the best out of the window, and keep the others spread across it
+    const uint64_t age = time - _samples[0].time;
+    if (age > _window) {
+        _samples[0] = _samples[1];
+        _samples[1] = _samples[2];
+        _samples[2] = sample;
+        if (time - _samples[0].time > _window) {
+            _samples[0] = _samples[1];
+            _samples[1] = _samples[2];
+        }
+    } else if (_samples[1].time == _samples[0].time and age > _window / 4) {
+        _samples[2] = _samples[1] = sample;
+    } else if (_samples[2].time == _samples[1].time and age > _window / 2) {
+        _samples[2] = sample;
+    }
+}
+
+BbrController::BbrController(const size_t mss, const size_t initial_cwnd)
+    : _mss(mss), _initial_cwnd(max(initial_cwnd, MIN_PIPE_SEGMENTS * mss)), _cwnd(_initial_cwnd) {}
+
+void BbrController::set_mss(const size_t mss) {
+    _mss = mss;
+    _initial_cwnd = max(_initial_cwnd, MIN_PIPE_SEGMENTS * mss);
+    _cwnd = max(_cwnd, MIN_PIPE_SEGMENTS * mss);
+}
+
+size_t BbrController::_inflight(const double gain) const {
+    if (not _min_rtt.has_value() or bottleneck_bandwidth() == 0) {
+        return _initial_cwnd;
+    }
+    // RTprop is measured in whole milliseconds, so a fast local path may show 0
+    const double bdp = bottleneck_bandwidth() * max<uint64_t>(_min_rtt.value(), 1);
+    return static_cast<size_t>(gain * bdp);
+}
+
+void BbrController::on_ack(const AckEvent &ack) {
+    const size_t newly_delivered = ack.delivered - _delivered;
+    _delivered = ack.delivered;
+
+    _update_round(ack);
+    _update_model(ack);
+    _check_full_pipe(ack);
+    _update_state(ack);
+    _set_pacing_rate();
+    _set_cwnd(ack, newly_delivered);
+}
+
+//! \details A round ends when a segment sent after the round began is delivered.
+void BbrController::_update_round(const AckEvent &ack) {
+    _round_start = false;
+    if (ack.sample.has_value() and ack.sample->prior_delivered >= _next_round_delivered) {
+        _next_round_delivered = ack.delivered;
+        _round_count++;
+        _round_start = true;
+    }
+}
+
+void BbrController::_update_model(const AckEvent &ack) {
+    // an app-limited sample only shows a lower bound on the bandwidth
+    if (ack.sample.has_value() and (not ack.sample->app_limited or ack.sample->rate() >= bottleneck_bandwidth())) {
+        _btl_bw.update(_round_count, ack.sample->rate());
+    }
+
+    const bool min_rtt_expired = _min_rtt.has_value() and ack.now > _min_rtt_stamp + MIN_RTT_FILTER_MS;
+    if (ack.rtt.has_value() and (not _min_rtt.has_value() or ack.rtt.value() <= _min_rtt.value() or min_rtt_expired)) {
+        _min_rtt = ack.rtt;
+        _min_rtt_stamp = ack.now;
+    }
+    _check_probe_rtt(ack, min_rtt_expired);
+}
+
+//! \details STARTUP is over once three rounds in a row (that weren't app-limited) failed to
+//! grow the bandwidth estimate by a quarter.
+void BbrController::_check_full_pipe(const AckEvent &ack) {
+    if (_filled_pipe or not _round_start or ack.sample->app_limited) {
+        return;
+    }
+    if (bottleneck_bandwidth() >= _full_bw * FULL_BW_GROWTH) {
+        _full_bw = bottleneck_bandwidth();
+        _full_bw_count = 0;
+        return;
+    }
+    if (++_full_bw_count >= FULL_BW_ROUNDS) {
+        _filled_pipe = true;
+    }
+}
+
+void BbrController::_update_state(const AckEvent &ack) {
+    if (_state == State::Startup and _filled_pipe) {
+        _state = State::Drain;
+        _pacing_gain = DRAIN_GAIN;
+        _cwnd_gain = HIGH_GAIN;
+    }
+    if (_state == State::Drain and ack.pipe <= _inflight(1)) {
+        _enter_probe_bw(ack.now);
+    }
+    if (_state == State::ProbeBw) {
+        _advance_cycle_phase(ack);
+    }
+}
+
+void BbrController::_enter_probe_bw(const uint64_t now) {
+    _state = State::ProbeBw;
+    _cwnd_gain = CWND_GAIN;
+    // begin in any phase but the draining one, so flows sharing a bottleneck don't probe in step
+    _cycle_index = uniform_int_distribution<size_t>{0, GAIN_CYCLE_LENGTH - 2}(_random);
+    if (_cycle_index > 0) {
+        _cycle_index++;
+    }
+    _cycle_stamp = now;
+    _pacing_gain = PACING_GAIN_CYCLE[_cycle_index];
+}
+
+//! \details Each phase lasts an RTprop. Probing also waits until the extra data is in flight
+//! (or was lost), and draining stops early once the queue is gone.
+void BbrController::_advance_cycle_phase(const AckEvent &ack) {
+    const bool full_length = ack.now - _cycle_stamp > _min_rtt.value_or(0);
+    bool next_phase = full_length;
+    if (_pacing_gain > 1) {
+        next_phase = full_length and (_recovery_point.has_value() or ack.pipe >= _inflight(_pacing_gain));
+    } else if (_pacing_gain < 1) {
+        next_phase = full_length or ack.pipe <= _inflight(1);
+    }
+    if (next_phase) {
+        _cycle_index = (_cycle_index + 1) % GAIN_CYCLE_LENGTH;
+        _cycle_stamp = ack.now;
+        _pacing_gain = PACING_GAIN_CYCLE[_cycle_index];
+    }
+}
+
+//! \details PROBE_RTT holds the window at MIN_PIPE_SEGMENTS for PROBE_RTT_MS and a round, so
+//! any queue drains and the next RTT samples show the path's propagation time.
+void BbrController::_check_probe_rtt(const AckEvent &ack, const bool min_rtt_expired) {
+    if (_state != State::ProbeRtt and min_rtt_expired) {
+        _save_cwnd();
+        _state = State::ProbeRtt;
+        _pacing_gain = 1;
+        _probe_rtt_done_stamp.reset();
+    }
+    if (_state != State::ProbeRtt) {
+        return;
+    }
+
+    if (not _probe_rtt_done_stamp.has_value()) {
+        if (ack.pipe <= MIN_PIPE_SEGMENTS * _mss) {
+            _probe_rtt_done_stamp = ack.now + PROBE_RTT_MS;
+            _probe_rtt_round_done = false;
+            _next_round_delivered = ack.delivered;
+        }
+        return;
+    }
+    if (_round_start) {
+        _probe_rtt_round_done = true;
+    }
+    if (_probe_rtt_round_done and ack.now >= _probe_rtt_done_stamp.value()) {
+        _min_rtt_stamp = ack.now;
+        _cwnd = max(_cwnd, _prior_cwnd);
+        if (_filled_pipe) {
+            _enter_probe_bw(ack.now);
+        } else {
+            _state = State::Startup;
+            _pacing_gain = _cwnd_gain = HIGH_GAIN;
+        }
+    }
+}
+
+void BbrController::_set_pacing_rate() {
+    if (bottleneck_bandwidth() == 0) {
+        return;
+    }
+    // until the pipe is full, a lower estimate (say, from a slow first round) mustn't slow the sender down
+    const double rate = _pacing_gain * bottleneck_bandwidth();
+    if (_filled_pipe or not _pacing_rate.has_value() or rate > _pacing_rate.value()) {
+        _pacing_rate = rate;
+    }
+}
+
+void BbrController::_set_cwnd(const AckEvent &ack, const size_t newly_delivered) {
+    if (_recovery_point.has_value() and ack.ackno >= _recovery_point.value()) {
+        _recovery_point.reset();
+        _packet_conservation = false;
+        _cwnd = max(_cwnd, _prior_cwnd);
+    }
+    if (_timed_out and _round_start) {
+        // what was resent at the timeout was delivered: the path works, so the model's window returns
+        _timed_out = false;
+        _cwnd = max(_cwnd, _prior_cwnd);
+    }
+    if (_packet_conservation and _round_start) {
+        _packet_conservation = false;  // a round into recovery: back to growing toward the target
+    }
+
+    // the target leaves room for a few segments the receiver holds back for a delayed ack
+    const size_t target = _inflight(_cwnd_gain) + 3 * _mss;
+    if (_packet_conservation) {
+        _cwnd = max(_cwnd, ack.pipe + newly_delivered);
+    } else if (_filled_pipe) {
+        _cwnd = min(_cwnd + newly_delivered, target);
+    } else if (_cwnd < target or ack.delivered < _initial_cwnd) {
+        _cwnd += newly_delivered;
+    }
+    _cwnd = max(_cwnd, MIN_PIPE_SEGMENTS * _mss);
+
+    if (_state == State::ProbeRtt) {
+        _cwnd = min(_cwnd, MIN_PIPE_SEGMENTS * _mss);
+    }
+}
+
+void BbrController::_save_cwnd() {
+    if (_recovery_point.has_value() or _state == State::ProbeRtt) {
+        _prior_cwnd = max(_prior_cwnd, _cwnd);
+    } else {
+        _prior_cwnd = _cwnd;
+    }
+}
+
+//! \details The model doesn't change: for one round, each segment delivered lets one more be sent,
+//! then the window grows back toward its target, and the saved window returns once recovery is over.
+void BbrController::on_loss(const uint64_t, const size_t, const uint64_t recovery_point, const size_t pipe) {
+    if (_recovery_point.has_value()) {
+        return;
+    }
+    _save_cwnd();
+    _recovery_point = recovery_point;
+    _packet_conservation = true;
+    _next_round_delivered = _delivered;
+    _cwnd = max(pipe, MIN_PIPE_SEGMENTS * _mss);
+}
+
+//! \details The window drops to one segment until a round passes, which means what was resent
+//! has been delivered. Nothing was delivered for a whole timeout, so the queue is surely gone:
+//! PROBE_RTT needn't wait for it to drain.
+void BbrController::on_rto(const uint64_t now, const size_t) {
+    _save_cwnd();
+    _recovery_point.reset();
+    _packet_conservation = false;
+    _timed_out = true;
+    _next_round_delivered = _delivered;
+    _cwnd = _mss;  // the loss window
+
+    if (_state == State::ProbeRtt) {
+        _probe_rtt_done_stamp = now;
+        _probe_rtt_round_done = true;
+    }
+}
@@ -0,0 +1,180 @@
+#ifndef SPONGE_LIBSPONGE_BBR_CONTROLLER_HH
+#define SPONGE_LIBSPONGE_BBR_CONTROLLER_HH
+
+#include "congestion_control.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+
+//! \brief The largest value seen over a sliding window of time (or rounds), kept in three samples
+//! \details Kathleen Nichols' algorithm: the best, second-best and third-best samples, each newer
+//! than the one before, so the next best is at hand when the best ages out of the window.
+class WindowedMaxFilter {
+  private:
+    struct Sample {
+        uint64_t time;  //!< when the sample was taken
+        double value;   //!< the sample
+    };
+
+    uint64_t _window;                  //!< How long a sample may stay the best
+    std::array<Sample, 3> _samples{};  //!< Best, second-best and third-best
+
+  public:
+    //! \param window how long (in the caller's units of time) a sample may stay the best
+    explicit WindowedMaxFilter(const uint64_t window) : _window(window) {}
+
+    //! \brief Add a sample taken at `time`, which mustn't be earlier than any sample before it
+    void update(const uint64_t time, const double value);
+
+    //! \returns the largest sample in the window (0 before any)
+    double get() const { return _samples[0].value; }
+};
+
+//! \brief BBR congestion control: paces at the bottleneck bandwidth it measures, and caps the
+//! window at a multiple of the bandwidth-delay product
+//! \details Per the IETF draft on [BBR](https://tools.ietf.org/html/draft-cardwell-iccrg-bbr-congestion-control-00).
+//! The model is a windowed maximum of delivery rate samples (BtlBw) and a windowed minimum of RTT
+//! samples (RTprop); loss doesn't shrink it, so random loss costs only the retransmissions.
+//! The state machine probes for more bandwidth in STARTUP, drains the queue that built in DRAIN,
+//! cycles its pacing gain around 1 in PROBE_BW, and every 10 seconds without a lower RTT sample
+//! lets the queue empty in PROBE_RTT to measure RTprop again.
+class BbrController : public CongestionController {
+  public:
+    //! \brief The phases of BBR's state machine
+    enum class State { Startup, Drain, ProbeBw, ProbeRtt };
+
+    static constexpr double HIGH_GAIN = 2.885;            //!< 2/ln(2): doubles the sending rate each round
+    static constexpr double DRAIN_GAIN = 1 / HIGH_GAIN;   //!< Empties in one round what STARTUP queued
+    static constexpr double CWND_GAIN = 2;                //!< Window cap in PROBE_BW, in BDPs
+    static constexpr size_t GAIN_CYCLE_LENGTH = 8;        //!< Phases in PROBE_BW's gain cycle
+    static constexpr uint64_t BTL_BW_FILTER_ROUNDS = 10;  //!< Window of the bandwidth filter, in rounds
+    static constexpr uint64_t MIN_RTT_FILTER_MS = 10000;  //!< Window of the RTprop filter
+    static constexpr uint64_t PROBE_RTT_MS = 200;         //!< Least time spent in PROBE_RTT
+    static constexpr size_t MIN_PIPE_SEGMENTS = 4;        //!< Smallest window, and the window in PROBE_RTT
+    static constexpr double FULL_BW_GROWTH = 1.25;        //!< Growth per round that means STARTUP isn't done
+    static constexpr unsigned FULL_BW_ROUNDS = 3;         //!< Rounds without it that mean the pipe is full
+
+    //! PROBE_BW's pacing gains: probe for more, drain what that queued, then cruise
+    static constexpr std::array<double, GAIN_CYCLE_LENGTH> PACING_GAIN_CYCLE{1.25, 0.75, 1, 1, 1, 1, 1, 1};
+
+  private:
+    size_t _mss;                           //!< Sender maximum segment size
+    size_t _initial_cwnd;                  //!< Window before the model has an estimate
+    size_t _cwnd;                          //!< Congestion window
+    size_t _prior_cwnd{0};                 //!< Window saved on entering recovery or PROBE_RTT
+    std::optional<double> _pacing_rate{};  //!< Bytes per ms, once there is a bandwidth estimate
+
+    State _state{State::Startup};    //!< Phase of the state machine
+    double _pacing_gain{HIGH_GAIN};  //!< Pacing rate, in BtlBw
+    double _cwnd_gain{HIGH_GAIN};    //!< Window cap, in BDPs
+
+    //! \name Round trips, counted by delivered data
+    //!@{
+    uint64_t _delivered{0};             //!< The sender's delivered count, as of the last ack
+    uint64_t _round_count{0};           //!< Round trips so far
+    uint64_t _next_round_delivered{0};  //!< The round ends once a segment sent after this much was delivered
+    bool _round_start{false};           //!< The last ack began a round
+    //!@}
+
+    //! \name The path model
+    //!@{
+    WindowedMaxFilter _btl_bw{BTL_BW_FILTER_ROUNDS};  //!< Bottleneck bandwidth, in bytes per ms
+    std::optional<uint64_t> _min_rtt{};               //!< Round-trip propagation time (RTprop), in ms
+    uint64_t _min_rtt_stamp{0};                       //!< When `_min_rtt` was measured
+    //!@}
+
+    //! \name STARTUP's full pipe detection
+    //!@{
+    bool _filled_pipe{false};    //!< The bandwidth estimate stopped growing
+    double _full_bw{0};          //!< The estimate at the last growth
+    unsigned _full_bw_count{0};  //!< Rounds since then
+    //!@}
+
+    //! \name PROBE_BW's gain cycle
+    //!@{
+    size_t _cycle_index{0};      //!< Current phase
+    uint64_t _cycle_stamp{0};    //!< When it began
+    std::minstd_rand _random{};  //!< Picks the phase PROBE_BW begins in
+    //!@}
+
+    //! \name PROBE_RTT
+    //!@{
+    std::optional<uint64_t> _probe_rtt_done_stamp{};  //!< Earliest time to leave, once the window has drained
+    bool _probe_rtt_round_done{false};                //!< A round has passed since the window drained
+    //!@}
+
+    //! \name Loss recovery
+    //!@{
+    std::optional<uint64_t> _recovery_point{};  //!< In fast recovery until this is acknowledged
+    bool _packet_conservation{false};           //!< For the first round of recovery, send one for one
+    bool _timed_out{false};                     //!< The window is the loss window until a round passes
+    //!@}
+
+    //! \returns the bandwidth-delay product times `gain`, or the initial window before there's a model
+    size_t _inflight(const double gain) const;
+
+    //! Count round trips
+    void _update_round(const AckEvent &ack);
+
+    //! Feed the ack's samples to the bandwidth and RTprop filters
+    void _update_model(const AckEvent &ack);
+
+    //! Decide whether STARTUP has filled the pipe
+    void _check_full_pipe(const AckEvent &ack);
+
+    //! Move from STARTUP to DRAIN to PROBE_BW, and around PROBE_BW's gain cycle
+    void _update_state(const AckEvent &ack);
+
+    //! Begin PROBE_BW's gain cycle
+    void _enter_probe_bw(const uint64_t now);
+
+    //! Move to PROBE_BW's next phase once the current one is done
+    void _advance_cycle_phase(const AckEvent &ack);
+
+    //! Enter PROBE_RTT once RTprop has gone unconfirmed too long, and leave it once it's measured again
+    void _check_probe_rtt(const AckEvent &ack, const bool min_rtt_expired);
+
+    //! Pace at the bandwidth estimate times the pacing gain
+    void _set_pacing_rate();
+
+    //! Grow the window toward the bandwidth-delay product times the cwnd gain
+    void _set_cwnd(const AckEvent &ack, const size_t newly_delivered);
+
+    //! Remember the window, to restore it once recovery or PROBE_RTT is over
+    void _save_cwnd();
+
+  public:
+    //! \param mss the sender maximum segment size
+    //! \param initial_cwnd the congestion window before there's a bandwidth estimate
+    BbrController(const size_t mss, const size_t initial_cwnd);
+
+    void on_ack(const AckEvent &ack) override;
+    void on_loss(const uint64_t now,
+                 const size_t bytes_in_flight,
+                 const uint64_t recovery_point,
+                 const size_t pipe) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    void set_mss(const size_t mss) override;
+    std::optional<double> pacing_rate() const override { return _pacing_rate; }
+
+    //! \returns the phase of the state machine
+    State state() const { return _state; }
+
+    //! \returns the bottleneck bandwidth estimate, in bytes per millisecond (0 before any sample)
+    double bottleneck_bandwidth() const { return _btl_bw.get(); }
+
+    //! \returns the round-trip propagation time estimate, in milliseconds
+    std::optional<uint64_t> min_rtt() const { return _min_rtt; }
+
+    //! \returns the number of round trips so far
+    uint64_t round_count() const { return _round_count; }
+
+    //! \returns the current pacing gain
+    double pacing_gain() const { return _pacing_gain; }
+};
+
+#endif  // SPONGE_LIBSPONGE_BBR_CONTROLLER_HH
@@ -11,9 +11,18 @@
 
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity) : _capacity{capacity} {}
+//! \param[in] capacity is the maximum number of bytes the stream buffers at once
+//! \param[in] backend selects the storage; Backend::Ring allocates all `capacity` bytes up front
+ByteStream::ByteStream(const size_t capacity, const Backend backend)
+    : _capacity{capacity}, _backend{backend}, _ring{backend == Backend::Ring ? capacity : 0} {}
 
 size_t ByteStream::write(const string &data) {
+    if (_backend == Backend::Ring) {
+        auto wc = _ring.write(data);
+        _bytes_written += wc;
+        return wc;
+    }
+
     auto data_size = data.size();
     auto wc = min(data_size, remaining_capacity());
     _bytes_written += wc;
@@ -26,6 +35,10 @@ size_t ByteStream::write(const string &data) {
 }
 
 size_t ByteStream::write(string &&data) {
+    if (_backend == Backend::Ring) {
+        return write(data);
+    }
+
     auto data_size = data.size();
     auto wc = min(data_size, remaining_capacity());
     _bytes_written += wc;
@@ -35,23 +48,89 @@ size_t ByteStream::write(string &&data) {
     return wc;
 }
 
+//! \param[in] data is the Buffer to append; bytes beyond the remaining capacity are discarded
+size_t ByteStream::write(Buffer data) {
+    if (_backend == Backend::Ring) {
+        auto wc = _ring.write(data);
+        _bytes_written += wc;
+        return wc;
+    }
+
+    auto data_size = data.size();
+    auto wc = min(data_size, remaining_capacity());
+    if (wc == 0) {
+        return 0;
+    }
+    _bytes_written += wc;
+    data.remove_suffix(data_size - wc);
+    _buffer.append(move(data));
+    return wc;
+}
+
+//! \param[in] data is the list of Buffers to append; bytes beyond the remaining capacity are discarded
+size_t ByteStream::write(const BufferList &data) {
+    size_t wc = 0;
+    for (const auto &buf : data.buffers()) {
+        const auto n = write(buf);
+        wc += n;
+        if (n < buf.size()) {
+            break;
+        }
+    }
+    return wc;
+}
+
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
-    auto remain = min(len, buffer_size());
     string ret;
-    ret.reserve(remain);
+    peek_output(ret, len);
+    return ret;
+}
+
+//! \param[out] out receives the bytes; its previous contents are replaced
+//! \param[in] len bytes will be copied from the output side of the buffer
+void ByteStream::peek_output(string &out, const size_t len) const {
+    auto remain = min(len, buffer_size());
+    out.clear();
+    out.reserve(remain);
+    if (_backend == Backend::Ring) {
+        _ring.peek(out, remain);
+        return;
+    }
+
     for (const auto &segment : _buffer.buffers()) {
         auto segment_size = segment.size();
         if (remain >= segment_size) {
-            ret.append(segment);
+            out.append(segment);
             remain -= segment_size;
             if (remain == 0) {
                 break;
             }
         } else {
-            ret.append(segment.str(remain));
+            out.append(segment.str(remain));
+            break;
+        }
+    }
+}
+
+//! \param[in] len bytes will be viewed from the output side of the buffer
+BufferViewList ByteStream::peek_output_view(const size_t len) const {
+    auto remain = min(len, buffer_size());
+    BufferViewList ret;
+    if (_backend == Backend::Ring) {
+        const auto [first, second] = _ring.peek_view(remain);
+        ret.append(first);
+        ret.append(second);
+        return ret;
+    }
+
+    for (const auto &segment : _buffer.buffers()) {
+        if (remain == 0) {
             break;
         }
+        const auto view = segment.str().substr(0, remain);
+        ret.append(view);
+        remain -= view.size();
     }
     return ret;
 }
@@ -60,7 +139,11 @@ string ByteStream::peek_output(const size_t len) const {
 void ByteStream::pop_output(const size_t len) {
     auto rc = min(len, buffer_size());
     _bytes_read += rc;
-    _buffer.remove_prefix(rc);
+    if (_backend == Backend::Ring) {
+        _ring.remove_prefix(rc);
+    } else {
+        _buffer.remove_prefix(rc);
+    }
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
@@ -72,6 +155,34 @@ std::string ByteStream::read(const size_t len) {
     return res;
 }
 
+//! \param[out] out receives the bytes; its previous contents are replaced
+//! \param[in] len bytes will be popped and copied into `out`
+void ByteStream::read(string &out, const size_t len) {
+    peek_output(out, len);
+    pop_output(len);
+}
+
+//! \param[in] len bytes will be popped and returned
+Buffer ByteStream::read_buffer(const size_t len) {
+    const auto rc = min(len, buffer_size());
+    if (rc == 0) {
+        return {};
+    }
+
+    if (_backend == Backend::Chunked) {
+        const auto &front = _buffer.buffers().front();
+        if (front.size() >= rc) {
+            Buffer ret = front.slice(0, rc);
+            pop_output(rc);
+            return ret;
+        }
+    }
+
+    string data;
+    read(data, rc);
+    return Buffer{move(data)};
+}
+
 void ByteStream::end_input() { _input_ended = true; }
 
 bool ByteStream::input_ended() const { return _input_ended; }
@@ -1,8 +1,10 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
-#include <string>
 #include "buffer.hh"
+#include "ring_buffer.hh"
+
+#include <string>
 
 //! \brief An in-order byte stream.
 
@@ -10,6 +12,13 @@
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
 class ByteStream {
+  public:
+    //! \brief How the buffered bytes are stored
+    enum class Backend {
+        Chunked,  //!< A BufferList holding one refcounted chunk per write
+        Ring      //!< A RingBuffer of `capacity` bytes, allocated once at construction
+    };
+
   private:
     // Your code here -- add private members as necessary.
 
@@ -23,11 +32,13 @@ class ByteStream {
     size_t _capacity{0};
     size_t _bytes_written{0};
     size_t _bytes_read{0};
-    BufferList _buffer{};
+    Backend _backend;
+    BufferList _buffer{};  //!< Storage for Backend::Chunked
+    RingBuffer _ring;      //!< Storage for Backend::Ring
 
   public:
     //! Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Backend backend = Backend::Chunked);
 
     //! \name "Input" interface for the writer
     //!@{
@@ -38,6 +49,15 @@ class ByteStream {
     size_t write(const std::string &data);
     size_t write(std::string &&data);
 
+    //! Write a refcounted Buffer without copying it (the chunked backend keeps a reference
+    //! to the Buffer's storage; the ring backend copies it).
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
+    //! Write each Buffer of a BufferList in order, without copying them
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const BufferList &data);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
@@ -55,6 +75,13 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! Peek at next "len" bytes of the stream into `out` (caller can allocate storage)
+    void peek_output(std::string &out, const size_t len) const;
+
+    //! Peek at next "len" bytes of the stream without copying them
+    //! \returns views of the buffered bytes, which stay valid until the next pop_output() or read()
+    BufferViewList peek_output_view(const size_t len) const;
+
     //! Remove bytes from the buffer
     void pop_output(const size_t len);
 
@@ -62,6 +89,14 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read the next "len" bytes of the stream into `out` (caller can allocate storage)
+    void read(std::string &out, const size_t len);
+
+    //! Read (i.e., slice and then pop) the next "len" bytes of the stream as one Buffer
+    //! \returns a slice of the stream's own storage if the bytes lie within one chunk,
+    //! otherwise a new Buffer holding a single copy of them
+    Buffer read_buffer(const size_t len);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
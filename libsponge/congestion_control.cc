@@ -0,0 +1,85 @@
+#include "congestion_control.hh"
+
+#include "bbr_controller.hh"
+#include "cubic_controller.hh"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+//! \param[in] config selects the algorithm, its initial window and the MSS
+unique_ptr<CongestionController> CongestionController::make(const TCPConfig &config) {
+    const size_t mss = config.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE);
+    switch (config.congestion_control) {
+        case TCPConfig::CongestionControl::NewReno:
+            return make_unique<NewRenoController>(mss, config.initial_cwnd);
+        case TCPConfig::CongestionControl::Cubic:
+            return make_unique<CubicController>(mss, config.initial_cwnd);
+        case TCPConfig::CongestionControl::Bbr:
+            return make_unique<BbrController>(mss, config.initial_cwnd);
+    }
+    throw runtime_error("unknown congestion control algorithm");
+}
+
+NewRenoController::NewRenoController(const size_t mss, const size_t initial_cwnd)
+    : _mss(mss), _cwnd(max(initial_cwnd, mss)), _ssthresh(numeric_limits<size_t>::max()) {}
+
+void NewRenoController::set_mss(const size_t mss) {
+    _mss = mss;
+    _cwnd = max(_cwnd, mss);
+}
+
+size_t NewRenoController::_reduced_ssthresh(const size_t bytes_in_flight) const {
+    return max(bytes_in_flight / 2, 2 * _mss);
+}
+
+void NewRenoController::on_ack(const AckEvent &ack) {
+    if (_recovery_point.has_value()) {
+        if (ack.ackno < _recovery_point.value()) {
+            return;  // a partial ack: stay in recovery
+        }
+        // full ack: deflate to ssthresh and resume congestion avoidance
+        _recovery_point.reset();
+        _cwnd = _ssthresh;
+        _bytes_acked = 0;
+        return;
+    }
+
+    if (_cwnd < _ssthresh) {
+        // slow start: one segment per ack (at most), doubling the window every round trip
+        _cwnd += min(ack.newly_acked, _mss);
+        return;
+    }
+
+    // congestion avoidance: one segment per window's worth of acknowledged bytes
+    _bytes_acked += ack.newly_acked;
+    if (_bytes_acked >= _cwnd) {
+        _bytes_acked -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+void NewRenoController::on_loss(const uint64_t,
+                                const size_t bytes_in_flight,
+                                const uint64_t recovery_point,
+                                const size_t) {
+    if (_recovery_point.has_value()) {
+        return;  // one reduction per window of losses
+    }
+    _ssthresh = _reduced_ssthresh(bytes_in_flight);
+    _cwnd = _ssthresh;
+    _bytes_acked = 0;
+    _recovery_point = recovery_point;
+}
+
+void NewRenoController::on_rto(const uint64_t, const size_t bytes_in_flight) {
+    // a second timeout before anything is acknowledged mustn't shrink ssthresh further
+    if (_cwnd > _mss) {
+        _ssthresh = _reduced_ssthresh(bytes_in_flight);
+    }
+    _cwnd = _mss;  // the loss window
+    _bytes_acked = 0;
+    _recovery_point.reset();
+}
@@ -0,0 +1,112 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include "tcp_config.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+//! \brief A delivery rate sample: how fast the network delivered data over the interval between
+//! sending a segment and its acknowledgment
+//! \details Per the IETF draft on
+//! [delivery rate estimation](https://tools.ietf.org/html/draft-cheng-iccrg-delivery-rate-estimation)
+struct RateSample {
+    uint64_t prior_delivered = 0;  //!< the sender's delivered count when the sampled segment was sent
+    uint64_t delivered = 0;        //!< bytes delivered over the interval
+    uint64_t interval = 0;         //!< length of the interval, in milliseconds (never 0)
+    bool app_limited = false;      //!< the sender ran out of data to send during the interval
+
+    //! \returns the delivery rate, in bytes per millisecond
+    double rate() const { return static_cast<double>(delivered) / interval; }
+};
+
+//! \brief What a TCPSender learned from an acknowledgment that advanced its ackno or SACKed new data
+struct AckEvent {
+    uint64_t now = 0;                    //!< the sender's clock, in milliseconds
+    uint64_t ackno = 0;                  //!< the new (absolute) ackno
+    uint64_t next_seqno = 0;             //!< the sender's (absolute) next seqno
+    size_t newly_acked = 0;              //!< bytes of sequence space newly acknowledged
+    size_t bytes_in_flight = 0;          //!< bytes still outstanding, after the ack
+    std::optional<uint64_t> rtt{};       //!< round-trip time of the newest segment acknowledged, unless it was resent
+    uint64_t delivered = 0;              //!< bytes delivered (acknowledged or SACKed) since the connection began
+    std::optional<RateSample> sample{};  //!< the delivery rate the ack measured, if it measured one
+    size_t pipe = 0;                     //!< bytes the sender estimates are still in the network, after the ack
+};
+
+//! \brief The congestion control algorithm of a TCPSender
+//! \details The sender reports acknowledgments, losses and timeouts; the controller
+//! answers with how much may be in flight (cwnd) and, optionally, how fast to send it.
+class CongestionController {
+  public:
+    //! Make the controller `config` asks for
+    static std::unique_ptr<CongestionController> make(const TCPConfig &config);
+
+    virtual ~CongestionController() = default;
+
+    //! \brief An acknowledgment advanced the sender's ackno, or SACKed new data
+    virtual void on_ack(const AckEvent &ack) = 0;
+
+    //! \brief The sender detected a loss from acknowledgments and began recovery
+    //! \param now is the sender's clock, in milliseconds
+    //! \param bytes_in_flight is the sender's outstanding sequence space (the FlightSize)
+    //! \param recovery_point is the sender's next seqno: recovery ends once it is acknowledged
+    //! \param pipe is how much of that the sender estimates is still in the network, the losses taken out
+    virtual void on_loss(const uint64_t now,
+                         const size_t bytes_in_flight,
+                         const uint64_t recovery_point,
+                         const size_t pipe) = 0;
+
+    //! \brief The retransmission timer expired
+    //! \param now is the sender's clock, in milliseconds
+    //! \param bytes_in_flight is the sender's outstanding sequence space (the FlightSize)
+    virtual void on_rto(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! \returns the congestion window: how many bytes may be in the network
+    virtual size_t cwnd() const = 0;
+
+    //! \brief The sender's maximum segment size changed, as it may once the handshake settles it
+    //! \details The windows keep their size in bytes; what is counted in segments from then on is
+    //! counted in the new ones.
+    virtual void set_mss(const size_t mss) = 0;
+
+    //! \returns the rate to pace segments at, in bytes per millisecond, or empty to send
+    //! as fast as the windows allow
+    virtual std::optional<double> pacing_rate() const { return {}; }
+};
+
+//! \brief Slow start, congestion avoidance and fast recovery, per [RFC 5681](\ref rfc::rfc5681)
+//! and [RFC 6582](\ref rfc::rfc6582)
+//! \details The window isn't grown during recovery; the sender's scoreboard decides what to
+//! (re)send within it, and the window settles at ssthresh when recovery ends.
+class NewRenoController : public CongestionController {
+  private:
+    size_t _mss;                                //!< Sender maximum segment size
+    size_t _cwnd;                               //!< Congestion window
+    size_t _ssthresh;                           //!< Slow start threshold
+    size_t _bytes_acked{0};                     //!< Bytes acknowledged toward the next congestion-avoidance increase
+    std::optional<uint64_t> _recovery_point{};  //!< In fast recovery until this is acknowledged
+
+    //! ssthresh after a loss: half the flight size, but at least two segments
+    size_t _reduced_ssthresh(const size_t bytes_in_flight) const;
+
+  public:
+    //! \param mss the sender maximum segment size
+    //! \param initial_cwnd the congestion window before any loss
+    NewRenoController(const size_t mss, const size_t initial_cwnd);
+
+    void on_ack(const AckEvent &ack) override;
+    void on_loss(const uint64_t now,
+                 const size_t bytes_in_flight,
+                 const uint64_t recovery_point,
+                 const size_t pipe) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    void set_mss(const size_t mss) override;
+
+    //! \returns the slow start threshold
+    size_t ssthresh() const { return _ssthresh; }
+};
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
@@ -0,0 +1,146 @@
+#include "cubic_controller.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+CubicController::CubicController(const size_t mss, const size_t initial_cwnd)
+    : _mss(mss)
+    , _cwnd(static_cast<double>(max(initial_cwnd, mss)) / mss)
+    , _ssthresh(numeric_limits<double>::infinity()) {}
+
+size_t CubicController::cwnd() const { return static_cast<size_t>(_cwnd * _mss); }
+
+//! \details The windows are counted in segments, so they are recounted in the new ones
+void CubicController::set_mss(const size_t mss) {
+    const double scale = static_cast<double>(_mss) / mss;
+    _cwnd *= scale;
+    _ssthresh *= scale;
+    _w_max *= scale;
+    _w_est *= scale;
+    _mss = mss;
+}
+
+size_t CubicController::ssthresh() const {
+    return isinf(_ssthresh) ? numeric_limits<size_t>::max() : static_cast<size_t>(_ssthresh * _mss);
+}
+
+void CubicController::on_ack(const AckEvent &ack) {
+    if (ack.rtt.has_value()) {
+        _min_rtt = min(_min_rtt.value_or(ack.rtt.value()), ack.rtt.value());
+    }
+
+    if (ack.newly_acked == 0) {
+        return;  // only SACKed data: the window grows with the ackno
+    }
+
+    if (_recovery_point.has_value()) {
+        if (ack.ackno < _recovery_point.value()) {
+            return;  // a partial ack: stay in recovery
+        }
+        _recovery_point.reset();  // the window already sits at ssthresh
+        return;
+    }
+
+    if (_cwnd < _ssthresh) {
+        _cwnd += static_cast<double>(min(ack.newly_acked, _mss)) / _mss;
+        // only the first slow start can overshoot blindly; later ones stop at ssthresh
+        if (isinf(_ssthresh)) {
+            _hystart_on_ack(ack);
+        }
+        return;
+    }
+
+    _congestion_avoidance(ack);
+}
+
+void CubicController::_hystart_on_ack(const AckEvent &ack) {
+    if (ack.ackno > _hystart.window_end) {
+        // everything sent in the last round has been acknowledged: start the next one
+        _hystart.last_min_rtt = _hystart.min_rtt;
+        _hystart.min_rtt.reset();
+        _hystart.samples = 0;
+        _hystart.window_end = ack.next_seqno;
+    }
+
+    if (not ack.rtt.has_value()) {
+        return;
+    }
+    _hystart.min_rtt = min(_hystart.min_rtt.value_or(ack.rtt.value()), ack.rtt.value());
+    ++_hystart.samples;
+
+    // RTT noise isn't taken for a queue while the window is still small
+    if (_hystart.samples < HYSTART_MIN_SAMPLES or not _hystart.last_min_rtt.has_value() or
+        _cwnd < HYSTART_LOW_WINDOW) {
+        return;
+    }
+    // a queue is building at the bottleneck: the window has reached the path's capacity
+    const uint64_t last = _hystart.last_min_rtt.value();
+    const uint64_t thresh = clamp(last / 8, HYSTART_MIN_RTT_THRESH, HYSTART_MAX_RTT_THRESH);
+    if (_hystart.min_rtt.value() >= last + thresh) {
+        _ssthresh = _cwnd;
+    }
+}
+
+void CubicController::_congestion_avoidance(const AckEvent &ack) {
+    if (not _epoch_start.has_value()) {
+        _epoch_start = ack.now;
+        if (_cwnd < _w_max) {
+            _k = cbrt((_w_max - _cwnd) / C);
+        } else {
+            // no reduction to recover from: probe upward from here
+            _k = 0;
+            _w_max = _cwnd;
+        }
+        _w_est = _cwnd;
+    }
+
+    const double acked = static_cast<double>(ack.newly_acked) / _mss;
+    const double t = static_cast<double>(ack.now - _epoch_start.value()) / 1000;
+    const double rtt = static_cast<double>(_min_rtt.value_or(0)) / 1000;
+    auto w_cubic = [&](const double time) { return C * pow(time - _k, 3) + _w_max; };
+
+    // the TCP-friendly region: never grow slower than standard TCP would
+    _w_est += ALPHA * acked / _cwnd;
+    if (w_cubic(t) < _w_est) {
+        _cwnd = max(_cwnd, _w_est);
+        return;
+    }
+
+    // aim for where the cubic function will be one round trip from now
+    const double target = clamp(w_cubic(t + rtt), _cwnd, 1.5 * _cwnd);
+    _cwnd += (target - _cwnd) / _cwnd * acked;
+}
+
+void CubicController::_reduce(const size_t bytes_in_flight) {
+    _epoch_start.reset();  // the next epoch begins when congestion avoidance resumes
+    // a window the receiver (or the application) kept from filling says nothing about the path
+    const double window = min(_cwnd, static_cast<double>(bytes_in_flight) / _mss);
+    // fast convergence: a window that keeps shrinking gives up some of its claim to newer flows
+    _w_max = window < _w_max ? window * (1 + BETA) / 2 : window;
+    _ssthresh = max(window * BETA, 2.0);
+}
+
+void CubicController::on_loss(const uint64_t,
+                              const size_t bytes_in_flight,
+                              const uint64_t recovery_point,
+                              const size_t) {
+    if (_recovery_point.has_value()) {
+        return;  // one reduction per window of losses
+    }
+    _reduce(bytes_in_flight);
+    _cwnd = _ssthresh;
+    _recovery_point = recovery_point;
+}
+
+void CubicController::on_rto(const uint64_t, const size_t bytes_in_flight) {
+    // a second timeout before anything is acknowledged mustn't reduce further
+    if (_cwnd > 1) {
+        _reduce(bytes_in_flight);
+    }
+    _cwnd = 1;  // the loss window
+    _epoch_start.reset();
+    _recovery_point.reset();
+}
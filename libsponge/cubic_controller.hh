@@ -0,0 +1,79 @@
+#ifndef SPONGE_LIBSPONGE_CUBIC_CONTROLLER_HH
+#define SPONGE_LIBSPONGE_CUBIC_CONTROLLER_HH
+
+#include "congestion_control.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+//! \brief CUBIC congestion control, per [RFC 8312](\ref rfc::rfc8312), leaving slow start
+//! by HyStart's delay-increase test, per [RFC 9406](\ref rfc::rfc9406)
+//! \details After a reduction the window follows a cubic function of the time since that
+//! reduction, not of the number of round trips, so it regains the window it lost (W_max)
+//! in about the same time on a long path as on a short one. Where standard TCP would grow
+//! faster (short round trips, small windows), the window follows an estimate of standard
+//! TCP's window instead (the TCP-friendly region). Windows are counted in segments.
+class CubicController : public CongestionController {
+  public:
+    static constexpr double C = 0.4;                              //!< Cubic growth, in segments per second cubed
+    static constexpr double BETA = 0.7;                           //!< Multiplicative decrease factor
+    static constexpr double ALPHA = 3 * (1 - BETA) / (1 + BETA);  //!< Standard TCP's growth, for the same BETA
+    static constexpr unsigned HYSTART_MIN_SAMPLES = 8;            //!< RTT samples HyStart needs per round
+    static constexpr uint64_t HYSTART_MIN_RTT_THRESH = 4;         //!< Smallest RTT increase that ends slow start, in ms
+    static constexpr uint64_t HYSTART_MAX_RTT_THRESH = 16;        //!< Largest RTT increase that ends slow start, in ms
+    static constexpr size_t HYSTART_LOW_WINDOW = 16;              //!< Smallest window HyStart ends, in segments
+
+  private:
+    size_t _mss;                                //!< Sender maximum segment size
+    double _cwnd;                               //!< Congestion window
+    double _ssthresh;                           //!< Slow start threshold
+    double _w_max{0};                           //!< Window just before the last reduction
+    double _k{0};                               //!< Seconds into the epoch at which the cubic reaches _w_max
+    double _w_est{0};                           //!< Standard TCP's window over the epoch
+    std::optional<uint64_t> _epoch_start{};     //!< When the current congestion avoidance epoch began
+    std::optional<uint64_t> _min_rtt{};         //!< Smallest RTT seen, in ms
+    std::optional<uint64_t> _recovery_point{};  //!< In fast recovery until this is acknowledged
+
+    //! HyStart's view of slow start, one round trip at a time
+    struct HyStartRound {
+        uint64_t window_end{0};                  //!< The round ends when this is acknowledged
+        std::optional<uint64_t> last_min_rtt{};  //!< Smallest RTT seen in the previous round
+        std::optional<uint64_t> min_rtt{};       //!< Smallest RTT seen so far in this round
+        unsigned samples{0};                     //!< RTT samples taken so far in this round
+    } _hystart{};
+
+    //! \brief Track the round's RTTs, and end slow start once they rise
+    void _hystart_on_ack(const AckEvent &ack);
+
+    //! \brief Grow the window toward the cubic function (or standard TCP's estimate)
+    void _congestion_avoidance(const AckEvent &ack);
+
+    //! \brief Remember the window being given up, and reduce ssthresh from it
+    void _reduce(const size_t bytes_in_flight);
+
+  public:
+    //! \param mss the sender maximum segment size
+    //! \param initial_cwnd the congestion window before any loss
+    CubicController(const size_t mss, const size_t initial_cwnd);
+
+    void on_ack(const AckEvent &ack) override;
+    void on_loss(const uint64_t now,
+                 const size_t bytes_in_flight,
+                 const uint64_t recovery_point,
+                 const size_t pipe) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override;
+    void set_mss(const size_t mss) override;
+
+    //! \returns the slow start threshold, in bytes
+    size_t ssthresh() const;
+
+    //! \returns the window just before the last reduction, in bytes
+    size_t w_max() const { return static_cast<size_t>(_w_max * _mss); }
+
+    //! \returns the time the current congestion avoidance epoch began, if it has
+    std::optional<uint64_t> epoch_start() const { return _epoch_start; }
+};
+
+#endif  // SPONGE_LIBSPONGE_CUBIC_CONTROLLER_HH
@@ -0,0 +1,46 @@
+#include "pacer.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+Pacer::Pacer(const size_t burst) : _burst(burst), _tokens(static_cast<double>(burst)) {}
+
+//! \details The bucket holds at least a millisecond's worth at `rate`: the clock runs no finer, so a
+//! smaller bucket would cap the rate at the burst allowance per ms.
+void Pacer::refill(const uint64_t now, const optional<double> rate) {
+    const double burst = static_cast<double>(_burst);
+    if (not rate.has_value() or rate.value() <= 0) {
+        _rate.reset();
+        _tokens = burst;
+    } else {
+        const double capacity = max(burst, rate.value());
+        _tokens = min(capacity, _tokens + rate.value() * static_cast<double>(now - min(now, _last_refill)));
+        _rate = rate;
+    }
+    _last_refill = now;
+    _holding_back = false;
+}
+
+bool Pacer::may_send() {
+    if (not _rate.has_value() or _tokens > 0) {
+        return true;
+    }
+    _holding_back = true;
+    return false;
+}
+
+void Pacer::consume(const size_t bytes) {
+    if (_rate.has_value()) {
+        _tokens -= static_cast<double>(bytes);
+    }
+}
+
+//! \details Empty if nothing is held back. At least 1 ms: the sender's clock doesn't run finer.
+optional<uint64_t> Pacer::time_until_release() const {
+    if (not _holding_back or not _rate.has_value()) {
+        return {};
+    }
+    return max(uint64_t{1}, static_cast<uint64_t>(floor(-_tokens / _rate.value())) + 1);
+}
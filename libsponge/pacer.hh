@@ -0,0 +1,47 @@
+#ifndef SPONGE_LIBSPONGE_PACER_HH
+#define SPONGE_LIBSPONGE_PACER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+//! \brief A token bucket that spreads a sender's segments out at a rate, rather than sending a
+//! window's worth back to back
+//! \details Tokens are bytes, earned at the pacing rate up to the burst allowance. A segment may be
+//! sent while any tokens are left, and may overdraw them: so a segment bigger than the burst still
+//! goes out, and the debt delays the next one. The rate is set at each refill, and without one
+//! nothing is held back. Times are in milliseconds, on the sender's clock.
+class Pacer {
+  private:
+    size_t _burst;                  //!< Most tokens the bucket holds: how much may go out at once after a pause
+    double _tokens;                 //!< Bytes that may be sent now; negative while repaying an overdraft
+    std::optional<double> _rate{};  //!< Bytes earned per ms, or empty if unpaced
+    uint64_t _last_refill{0};       //!< When tokens were last earned
+    bool _holding_back{false};      //!< The sender had data to send that the pacer held back
+
+  public:
+    //! \param burst is the most that may be sent at once, in bytes
+    explicit Pacer(const size_t burst);
+
+    //! \brief Earn tokens for the time since the last refill, and set the rate until the next
+    //! \param now is the sender's clock
+    //! \param rate is the pacing rate in bytes per ms, or empty if unpaced (which fills the bucket)
+    void refill(const uint64_t now, const std::optional<double> rate);
+
+    //! \returns whether a segment may be sent now; if not, remembers that one was held back
+    bool may_send();
+
+    //! \brief Pay for `bytes` sent
+    void consume(const size_t bytes);
+
+    //! \returns whether a segment has been held back since the last refill
+    bool holding_back() const { return _holding_back; }
+
+    //! \returns how many ms from the last refill until a held-back segment may be sent
+    std::optional<uint64_t> time_until_release() const;
+
+    //! \returns the tokens in the bucket
+    double tokens() const { return _tokens; }
+};
+
+#endif  // SPONGE_LIBSPONGE_PACER_HH
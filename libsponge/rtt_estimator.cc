@@ -0,0 +1,33 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RTTEstimator::RTTEstimator(const uint64_t initial_rto, const uint64_t rto_min, const uint64_t rto_max)
+    : _initial_rto(initial_rto), _rto_min(rto_min), _rto_max(max(rto_max, rto_min)) {}
+
+//! \param[in] rtt is the round-trip time measured, in milliseconds
+void RTTEstimator::sample(const uint64_t rtt) {
+    const double r = static_cast<double>(rtt);
+    if (not _srtt.has_value()) {
+        _srtt = r;
+        _rttvar = r / 2;
+    } else {
+        // RTTVAR first: it uses the SRTT from before this sample
+        _rttvar = (1 - BETA) * _rttvar + BETA * abs(_srtt.value() - r);
+        _srtt = (1 - ALPHA) * _srtt.value() + ALPHA * r;
+    }
+    _min_rtt = min(_min_rtt.value_or(rtt), rtt);
+    _latest = rtt;
+    _samples++;
+}
+
+uint64_t RTTEstimator::rto() const {
+    if (not _srtt.has_value()) {
+        return _initial_rto;
+    }
+    const auto rto = static_cast<uint64_t>(ceil(_srtt.value() + max(G, K * _rttvar)));
+    return clamp(rto, _rto_min, _rto_max);
+}
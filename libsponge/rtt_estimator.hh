@@ -0,0 +1,59 @@
+#ifndef SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
+#define SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
+
+#include <cstdint>
+#include <optional>
+
+//! \brief Smoothed round-trip time and the retransmission timeout derived from it,
+//! per [RFC 6298](\ref rfc::rfc6298)
+//! \details The caller supplies only valid samples: per Karn's algorithm, none from a
+//! segment that was retransmitted. Times are in milliseconds.
+class RTTEstimator {
+  public:
+    static constexpr double ALPHA = 1.0 / 8;  //!< Gain of the SRTT filter
+    static constexpr double BETA = 1.0 / 4;   //!< Gain of the RTTVAR filter
+    static constexpr double K = 4;            //!< RTTVAR's weight in the RTO
+    static constexpr double G = 1;            //!< Clock granularity: the sender's tick is 1 ms at finest
+
+  private:
+    uint64_t _initial_rto;               //!< RTO before the first sample
+    uint64_t _rto_min;                   //!< Smallest RTO the estimate may give
+    uint64_t _rto_max;                   //!< Largest RTO the estimate may give
+    std::optional<double> _srtt{};       //!< Smoothed round-trip time
+    double _rttvar{0};                   //!< Round-trip time variation
+    std::optional<uint64_t> _min_rtt{};  //!< Smallest sample
+    std::optional<uint64_t> _latest{};   //!< Most recent sample
+    unsigned _samples{0};                //!< Samples so far
+
+  public:
+    //! \param initial_rto the RTO before the first sample
+    //! \param rto_min the smallest RTO the estimate may give
+    //! \param rto_max the largest RTO the estimate may give
+    RTTEstimator(const uint64_t initial_rto, const uint64_t rto_min, const uint64_t rto_max);
+
+    //! \brief Fold in a round-trip time measured from a segment sent only once
+    void sample(const uint64_t rtt);
+
+    //! \returns the retransmission timeout: SRTT + max(G, K * RTTVAR), clamped to [rto_min, rto_max]
+    uint64_t rto() const;
+
+    //! \returns the smoothed round-trip time, once there's a sample
+    std::optional<double> srtt() const { return _srtt; }
+
+    //! \returns the round-trip time variation
+    double rttvar() const { return _rttvar; }
+
+    //! \returns the smallest sample
+    std::optional<uint64_t> min_rtt() const { return _min_rtt; }
+
+    //! \returns the most recent sample
+    std::optional<uint64_t> latest_rtt() const { return _latest; }
+
+    //! \returns the number of samples so far
+    unsigned samples() const { return _samples; }
+
+    //! \returns the largest RTO the estimate may give
+    uint64_t rto_max() const { return _rto_max; }
+};
+
+#endif  // SPONGE_LIBSPONGE_RTT_ESTIMATOR_HH
@@ -1,7 +1,7 @@
-#include <iostream>
-
 #include "stream_reassembler.hh"
 
+#include <algorithm>
+
 // Dummy implementation of a stream reassembler.
 
 // For Lab 1, please replace with a real implementation that passes the
@@ -12,17 +12,26 @@
 
 using namespace std;
 
-StreamReassembler::StreamReassembler(const size_t capacity) : _output(capacity), _capacity(capacity) {}
+StreamReassembler::StreamReassembler(const size_t capacity)
+    : _output(capacity), _capacity(capacity), _buffer(capacity, 0), _occupied(capacity) {}
 
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
+    _push(data, nullptr, index, eof);
+}
+
+void StreamReassembler::push_substring(const Buffer &data, const size_t index, const bool eof) {
+    _push(data, &data, index, eof);
+}
+
+void StreamReassembler::_push(const string_view data, const Buffer *buffer, const uint64_t index, const bool eof) {
     if (_output.input_ended()) {
         return;
     }
 
-    auto expected = _output.bytes_written();
+    const uint64_t expected = _output.bytes_written();
     if (index + data.size() < expected) {
         return;
     }
@@ -32,44 +41,33 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
         _end_index = index + data.size();
     }
 
-    auto len = data.size();
-
-    // trim the overflow data
-    if (index + data.size() > expected + _capacity) {
-        len = expected + _capacity - index;
-    }
-
-    Segment segment{index, string_view{data.c_str(), len}};
-    if (segment.start_index() < expected) {
-        segment.remove_prefix(expected - segment.start_index());
-    }
-
-    push_interval(segment);
-
-    // reassemble
-    while (not _segments.empty()) {
-        auto it = _segments.begin();
-        // index start from 0
-        if (it->start_index() == _output.bytes_written()) {
-            size_t wc = _output.write(string{it->str()});
-            if (wc == 0) {
-                break;
+    // trim the data already assembled, and the overflow data
+    uint64_t begin = max<uint64_t>(index, expected);
+    const uint64_t end = min<uint64_t>(index + data.size(), expected + _capacity);
+
+    // in-order bytes go straight into the output stream, superseding any stored copies of them
+    if (begin == expected and begin < end) {
+        const size_t len = min<uint64_t>(end - begin, _output.remaining_capacity());
+        if (len > 0) {
+            const size_t pos = begin % _capacity;
+            const size_t first = min(len, _capacity - pos);
+            _unassembled_bytes -= _occupied.clear(pos, first);
+            _unassembled_bytes -= _occupied.clear(0, len - first);
+
+            if (buffer) {
+                _output.write(buffer->slice(begin - index, len));
+            } else {
+                _output.write(string{data.substr(begin - index, len)});
             }
-            _unassembled_bytes -= wc;
-            if (wc < it->size()) {
-                Segment trimmed = *it;
-                trimmed.remove_prefix(wc);
-                _segments.erase(_segments.begin());
-                _segments.insert(trimmed);
-                break;
-            }
-
-            _segments.erase(_segments.begin());
-        } else {
-            break;
+            begin += len;
         }
     }
 
+    if (begin < end) {
+        _store(data.substr(begin - index, end - begin), begin);
+    }
+    _assemble();
+
     if (_got_eof and _end_index == _output.bytes_written()) {
         _output.end_input();
     }
@@ -79,45 +77,162 @@ size_t StreamReassembler::unassembled_bytes() const { return _unassembled_bytes;
 
 bool StreamReassembler::empty() const { return _unassembled_bytes == 0; }
 
-void StreamReassembler::push_interval(Segment &segment) {
-    if (segment.size() == 0) {
+void StreamReassembler::_store(const string_view data, const uint64_t index) {
+    const size_t pos = index % _capacity;
+    const size_t first = min(data.size(), _capacity - pos);
+
+    data.copy(_buffer.data() + pos, first);
+    data.copy(_buffer.data(), data.size() - first, first);
+
+    _unassembled_bytes += _occupied.set(pos, first);
+    _unassembled_bytes += _occupied.set(0, data.size() - first);
+
+    _recent_stores[_recent_count++ % RECENT_STORES] = index;
+}
+
+void StreamReassembler::_assemble() {
+    if (_unassembled_bytes == 0) {
         return;
     }
 
-    // ensure no overlap with prev
-    auto it = lower_bound(_segments.begin(), _segments.end(), segment.start_index());
-    auto remove_begin = it;
-    if (it != _segments.end()) {
-        assert(it->end_index() >= segment.start_index());
-        if (it->start_index() <= segment.start_index()) {
-            size_t remove_n = it->end_index() - segment.start_index();
-            if (remove_n > segment.size()) {
-                return;
-            }
-            segment.remove_prefix(remove_n);
-            ++remove_begin;
+    const size_t pos = _output.bytes_written() % _capacity;
+
+    // how many bytes are contiguous from the front of the window
+    const size_t ready = _stored_run_from(_output.bytes_written(), _output.remaining_capacity());
+    if (ready == 0) {
+        return;
+    }
+
+    const size_t first = min(ready, _capacity - pos);
+    Buffer chunk = Buffer::allocate(ready);
+    _buffer.copy(chunk.mutable_data(), first, pos);
+    _buffer.copy(chunk.mutable_data() + first, ready - first, 0);
+
+    _occupied.clear(pos, first);
+    _occupied.clear(0, ready - first);
+    _unassembled_bytes -= ready;
+
+    _output.write(move(chunk));
+}
+
+//! \details The run may wrap around the end of `_buffer`.
+size_t StreamReassembler::_stored_run_from(const uint64_t index, const size_t limit) const {
+    const size_t pos = index % _capacity;
+    size_t run = _occupied.run_length(pos, min(limit, _capacity - pos));
+    if (run == _capacity - pos and run < limit) {
+        run += _occupied.run_length(0, limit - run);
+    }
+    return run;
+}
+
+//! \details The run may wrap around the start of `_buffer`.
+size_t StreamReassembler::_stored_run_before(const uint64_t index, const size_t limit) const {
+    const size_t pos = index % _capacity;
+    size_t run = _occupied.run_length_before(pos, min(limit, pos));
+    if (run == pos and run < limit) {
+        run += _occupied.run_length_before(_capacity, limit - run);
+    }
+    return run;
+}
+
+SmallVector<StreamReassembler::Range, 4> StreamReassembler::stored_ranges(const size_t max_ranges) const {
+    SmallVector<Range, 4> ret;
+    if (_unassembled_bytes == 0) {
+        return ret;
+    }
+
+    const uint64_t window_begin = _output.bytes_written();
+    const uint64_t window_end = window_begin + _capacity;
+
+    // walk the recorded stores from newest to oldest, expanding each still-stored one to its whole run
+    const size_t recorded = min(_recent_count, RECENT_STORES);
+    for (size_t i = 1; i <= recorded and ret.size() < max_ranges; i++) {
+        const uint64_t index = _recent_stores[(_recent_count - i) % RECENT_STORES];
+        if (index < window_begin or index >= window_end or _stored_run_from(index, 1) == 0) {
+            continue;  // assembled since it was stored
+        }
+
+        const uint64_t begin = index - _stored_run_before(index, index - window_begin);
+        if (any_of(ret.begin(), ret.end(), [&](const Range &r) { return r.first == begin; })) {
+            continue;
         }
+        ret.push_back({begin, index + _stored_run_from(index, window_end - index)});
     }
 
-    // ensure no overlap with behind
-    it = lower_bound(_segments.begin(), _segments.end(), segment.end_index());
-    auto remove_end = it;
-    if (it != _segments.end()) {
-        assert(it->end_index() >= segment.end_index());
-        if (it->start_index() <= segment.end_index()) {
-            size_t remove_n = segment.end_index() - it->start_index();
-            if (remove_n > segment.size()) {
-                return;
-            }
-            segment.remove_suffix(remove_n);
+    sort(ret.begin(), ret.end());
+    return ret;
+}
+
+//! \param[in] len bits are set, starting at bit `begin`
+size_t OccupancyBitmap::set(size_t begin, size_t len) {
+    size_t newly_set = 0;
+    while (len > 0) {
+        const size_t bit = begin % 64;
+        const size_t n = min<size_t>(len, 64 - bit);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << bit;
+
+        uint64_t &word = _words[begin / 64];
+        newly_set += __builtin_popcountll(mask & ~word);
+        word |= mask;
+
+        begin += n;
+        len -= n;
+    }
+    return newly_set;
+}
+
+//! \param[in] len bits are cleared, starting at bit `begin`
+size_t OccupancyBitmap::clear(size_t begin, size_t len) {
+    size_t newly_clear = 0;
+    while (len > 0) {
+        const size_t bit = begin % 64;
+        const size_t n = min<size_t>(len, 64 - bit);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1) << bit;
+
+        uint64_t &word = _words[begin / 64];
+        newly_clear += __builtin_popcountll(mask & word);
+        word &= ~mask;
+
+        begin += n;
+        len -= n;
+    }
+    return newly_clear;
+}
+
+//! \param[in] begin is the first bit to examine
+//! \param[in] limit is the most bits to examine
+size_t OccupancyBitmap::run_length(const size_t begin, const size_t limit) const {
+    size_t run = 0;
+    while (run < limit) {
+        const size_t bit = (begin + run) % 64;
+        const uint64_t clear_bits = ~_words[(begin + run) / 64] >> bit;
+        const size_t available = 64 - bit;
+        const size_t ones = clear_bits == 0 ? available : min<size_t>(__builtin_ctzll(clear_bits), available);
+
+        run += ones;
+        if (ones < available) {
+            break;
         }
     }
+    return min(run, limit);
+}
 
-    // remove overlapping segments
-    for (it = remove_begin; it != remove_end; it++) {
-        _unassembled_bytes -= it->size();
+//! \param[in] end is one past the last bit to examine
+//! \param[in] limit is the most bits to examine
+size_t OccupancyBitmap::run_length_before(const size_t end, const size_t limit) const {
+    size_t run = 0;
+    while (run < limit) {
+        const size_t last = end - run - 1;
+        const size_t bit = last % 64;
+        // shift so that bit `last` is the top bit; the bits shifted in are "clear" but lie beyond `available`
+        const uint64_t clear_bits = ~_words[last / 64] << (63 - bit);
+        const size_t available = bit + 1;
+        const size_t ones = clear_bits == 0 ? available : min<size_t>(__builtin_clzll(clear_bits), available);
+
+        run += ones;
+        if (ones < available) {
+            break;
+        }
     }
-    _segments.erase(remove_begin, remove_end);
-    _segments.insert(segment);
-    _unassembled_bytes += segment.size();
-}
\ No newline at end of file
+    return min(run, limit);
+}
@@ -2,48 +2,38 @@
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
 #include "byte_stream.hh"
+#include "small_vector.hh"
 
-#include <cassert>
+#include <array>
 #include <cstdint>
-#include <set>
 #include <string>
+#include <string_view>
+#include <vector>
 
-class Segment {
+//! \brief A fixed-size array of bits, one per byte of a StreamReassembler's window, recording which bytes are stored
+//! \details Operations work a 64-bit word at a time, so their cost is proportional to the number of
+//! bytes covered divided by 64, no matter how many separate ranges are stored.
+class OccupancyBitmap {
   private:
-    // initial
-    size_t _index{};
-    Buffer _data{};
-
-    // for trim prefix and suffix
-    size_t _start_index{};
-    size_t _end_index{};
+    std::vector<uint64_t> _words;
 
   public:
-    Segment(const size_t index, const std::string_view &data) : _index{index}, _data{std::string{data}}, _start_index{index}, _end_index{index + data.size()} {}
-
-    // we don't actually operate on the data
-    void remove_prefix(size_t n) {
-        _start_index += n;
-        assert(_start_index <= _end_index);
-    }
-    void remove_suffix(size_t n) {
-        _end_index -= n;
-        assert(_start_index <= _end_index);
-    }
-
-    size_t size() const { return str().size(); }
-    size_t start_index() const { return _start_index; }
-    size_t end_index() const { return _end_index; }
-    const Buffer &buffer() const { return _data; }
-
-    // return the string view which shadows the trimmed part
-    std::string_view str() const {
-        return { _data.str().begin() + _start_index - _index, _end_index - _start_index};
-    }
-    bool operator < (const size_t &rhs) const { return end_index() < rhs; }
-    // ensure no overlapping when insert, so we can simply compare the start index
-    bool operator < (const Segment &rhs) const { return start_index() < rhs.start_index(); }
+    //! \brief Construct with `size` bits, all clear
+    explicit OccupancyBitmap(const size_t size) : _words((size + 63) / 64) {}
+
+    //! \brief Set bits [begin, begin + len)
+    //! \returns how many of them were clear before
+    size_t set(size_t begin, size_t len);
+
+    //! \brief Clear bits [begin, begin + len)
+    //! \returns how many of them were set before
+    size_t clear(size_t begin, size_t len);
+
+    //! \returns the number of consecutive set bits starting at bit `begin`, up to at most `limit`
+    size_t run_length(const size_t begin, const size_t limit) const;
 
+    //! \returns the number of consecutive set bits ending just before bit `end`, up to at most `limit`
+    size_t run_length_before(const size_t end, const size_t limit) const;
 };
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
@@ -57,9 +47,31 @@ class StreamReassembler {
     size_t _end_index{0};
     size_t _unassembled_bytes{0};
     bool _got_eof{false};
-    std::set<Segment> _segments{};
 
-    void push_interval(Segment &segment);
+    //! Unassembled bytes, stored in a ring: the byte at stream index `i` lives at `_buffer[i % _capacity]`.
+    //! The window of acceptable indices, [bytes_written, bytes_written + capacity), never wraps onto itself.
+    std::string _buffer;
+    OccupancyBitmap _occupied;  //!< Which bytes of `_buffer` hold unassembled data
+
+    //! How many recent out-of-order stores are remembered for stored_ranges()
+    static constexpr size_t RECENT_STORES = 16;
+    std::array<uint64_t, RECENT_STORES> _recent_stores{};  //!< Stream indices of recent stores, as a ring
+    size_t _recent_count{0};                               //!< Total number of stores ever recorded
+
+    //! Common implementation of push_substring(); if `buffer` is non-null, `data` is a view of it
+    void _push(const std::string_view data, const Buffer *buffer, const uint64_t index, const bool eof);
+
+    //! Copy `data`, which fits in the window, into `_buffer` at stream index `index`
+    void _store(const std::string_view data, const uint64_t index);
+
+    //! Write the contiguous bytes (if any) at the front of the window into the output stream
+    void _assemble();
+
+    //! Number of consecutive stored bytes starting at stream index `index`, up to `limit`
+    size_t _stored_run_from(const uint64_t index, const size_t limit) const;
+
+    //! Number of consecutive stored bytes ending just before stream index `index`, up to `limit`
+    size_t _stored_run_before(const uint64_t index, const size_t limit) const;
 
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
@@ -77,6 +89,21 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring held in a Buffer (e.g. a segment payload) without copying it if possible
+    //! \details Bytes that can go straight into the stream are written as slices of `data`, sharing
+    //! its storage. Bytes that must wait for a gap to be filled are copied, once.
+    void push_substring(const Buffer &data, const uint64_t index, const bool eof);
+
+    //! A range [first, second) of stream indices
+    using Range = std::pair<uint64_t, uint64_t>;
+
+    //! \brief The stored (out-of-order) ranges containing the most recently received data
+    //! \details Each range is a maximal run of stored bytes. The runs holding the latest
+    //! stores are chosen first, as [RFC 2018](\ref rfc::rfc2018) asks of SACK blocks,
+    //! then the result is put in stream order.
+    //! \param max_ranges is the most ranges to return
+    SmallVector<Range, 4> stored_ranges(const size_t max_ranges) const;
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
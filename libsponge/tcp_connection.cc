@@ -1,6 +1,8 @@
 #include "tcp_connection.hh"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 // Dummy implementation of a TCP connection
 
@@ -9,6 +11,16 @@
 
 using namespace std;
 
+TCPConnection::TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {
+    _sender.set_mss(_advertised_mss());
+    _sender.set_nagle(_cfg.nagle);
+    _receiver.enable_sws_avoidance(_advertised_mss());
+    _sender.enable_persist_timer();
+    if (_cfg.pacing) {
+        _sender.enable_pacing(_cfg.pacing_rate, _cfg.pacing_burst);
+    }
+}
+
 size_t TCPConnection::remaining_outbound_capacity() const { return _sender.stream_in().remaining_capacity(); }
 
 size_t TCPConnection::bytes_in_flight() const { return _sender.bytes_in_flight(); }
@@ -31,10 +43,39 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
     if (_receiver.in_listen() and not seg.header().syn) return;
     if (_sender.in_syn_sent() and seg.header().ack and seg.payload().size() > 0) return;
 
-    // give the segment to receiver
-    _receiver.segment_received(seg);
+    if (seg.header().syn and seg.header().sack_permitted and _cfg.sack) {
+        _sack_enabled = true;
+        if (_cfg.rack_tlp) {
+            _sender.enable_rack_tlp();
+        }
+    }
+    // send no bigger segments than the peer can take; a peer that gives no MSS gets ours
+    if (seg.header().syn and seg.header().mss.value_or(0) > 0) {
+        _sender.set_mss(min<size_t>(_advertised_mss(), seg.header().mss.value()));
+    }
+    if (seg.header().syn and seg.header().window_scale.has_value() and _cfg.window_scaling) {
+        _window_scaling_enabled = true;
+        _receiver.enable_window_scaling(_offered_window_shift());
+        _sender.enable_window_scaling(min(seg.header().window_scale.value(), TCPHeader::MAX_WINDOW_SCALE));
+    }
+
+    if (seg.header().syn and seg.header().has_timestamps and _cfg.timestamps) {
+        _timestamps_enabled = true;
+        _receiver.enable_timestamps();
+        _sender.enable_timestamps();
+    }
+
+    // give the segment to receiver; an old duplicate it rejects (PAWS) is acknowledged, and otherwise ignored
+    const auto ackno_before = _receiver.ackno();
+    const bool gap_before = _receiver.unassembled_bytes() > 0;
+    if (not _receiver.segment_received(seg)) {
+        _sender.send_empty_segment();
+        _send_outbound_segments();
+        return;
+    }
+    _update_options_length();
     if (seg.header().ack and _sender.next_seqno_absolute() > 0) {
-        _sender.ack_received(seg.header().ackno, seg.header().win);
+        _sender.ack_received(seg);
         _sender.fill_window();
     }
 
@@ -44,7 +85,18 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         _sender.fill_window();
     } else if (seg.length_in_sequence_space() > 0 and _sender.next_seqno_absolute() > 0) {
         // should syn first
-        _sender.send_empty_segment();
+        _segments_unacked++;
+        // in-order data, taken whole, may wait for another segment or the delay timer; a segment out of order,
+        // filling a gap, not taken (or only in part) or carrying a FIN is acknowledged at once
+        const auto taken = static_cast<size_t>(_receiver.ackno().value() - ackno_before.value_or(seg.header().seqno));
+        const bool in_order = ackno_before.has_value() and seg.header().seqno == ackno_before.value() and
+                              taken == seg.length_in_sequence_space() and not gap_before and not seg.header().fin;
+        if (not _cfg.ack_delay.has_value() or not in_order or _segments_unacked >= 2) {
+            // data the sender just sent carries the ack; otherwise it goes alone
+            if (_sender.segments_out().empty()) {
+                _sender.send_empty_segment();
+            }
+        }
     }
 
     _send_outbound_segments();
@@ -75,11 +127,43 @@ size_t TCPConnection::write(const string &data) {
     return wc;
 }
 
+size_t TCPConnection::write(Buffer data) {
+    auto wc = _sender.stream_in().write(move(data));
+    _sender.fill_window();
+    _send_outbound_segments();
+    return wc;
+}
+
+size_t TCPConnection::write(const BufferList &data) {
+    auto wc = _sender.stream_in().write(data);
+    _sender.fill_window();
+    _send_outbound_segments();
+    return wc;
+}
+
+void TCPConnection::uncork() {
+    _sender.uncork();
+    // before connect(), there's nothing to send (and filling the window would send the SYN)
+    if (not _sender.in_closed()) {
+        _sender.fill_window();
+        _send_outbound_segments();
+    }
+}
+
 //! \param[in] ms_since_last_tick number of milliseconds since the last call to this method
 void TCPConnection::tick(const size_t ms_since_last_tick) {
     _time_since_last_segment_received += ms_since_last_tick;
     _sender.tick(ms_since_last_tick);
 
+    if (_segments_unacked > 0 and _cfg.ack_delay.has_value()) {
+        _ack_delay_elapsed += ms_since_last_tick;
+        if (_ack_delay_elapsed >= _cfg.ack_delay.value() and _sender.segments_out().empty()) {
+            _sender.send_empty_segment();
+        }
+    }
+
+    _send_window_update();
+
     if (_sender.consecutive_retransmissions() > TCPConfig::MAX_RETX_ATTEMPTS) {
         _reset(true);
     }
@@ -88,6 +172,19 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
     _check_done();
 }
 
+void TCPConnection::inbound_read() {
+    _send_window_update();
+    _send_outbound_segments();
+}
+
+//! \details Only once the peer's SYN has come, and not once its FIN has: then it has nothing more to send.
+void TCPConnection::_send_window_update() {
+    if (_active and not _receiver.in_listen() and not _receiver.in_fin_recv() and _receiver.window_opened() and
+        _sender.segments_out().empty()) {
+        _sender.send_empty_segment();
+    }
+}
+
 void TCPConnection::end_input_stream() {
     _sender.stream_in().end_input();
     _sender.fill_window();
@@ -125,19 +222,68 @@ void TCPConnection::_send_outbound_segments() {
         if (receiver_ackno.has_value()) {
             seg.header().ack = true;
             seg.header().ackno = receiver_ackno.value();
+            _segments_unacked = 0;
+            _ack_delay_elapsed = 0;
         }
-        if (_receiver.window_size() > numeric_limits<char16_t>::max()) {
-            seg.header().win = numeric_limits<char16_t>::max();
-        } else {
-            seg.header().win = _receiver.window_size();
-        }
+        // the window on a SYN is never scaled
+        const uint8_t shift = seg.header().syn ? 0 : _receiver.window_shift();
+        seg.header().win = min<size_t>(_receiver.window_size() >> shift, numeric_limits<uint16_t>::max());
+        _receiver.window_advertised(size_t{seg.header().win} << shift);
         if (_rst_set) {
             seg.header().rst = true;
         }
+        // give our MSS on our SYN, and offer SACK and window scaling, unless it answers a SYN that didn't offer them
+        if (seg.header().syn) {
+            seg.header().mss = _advertised_mss();
+            seg.header().sack_permitted = _cfg.sack and (not receiver_ackno.has_value() or _sack_enabled);
+            if (_cfg.window_scaling and (not receiver_ackno.has_value() or _window_scaling_enabled)) {
+                seg.header().window_scale = _offered_window_shift();
+            }
+        }
+        // once agreed, every segment carries timestamps, echoing the peer's latest (or 0 on our first SYN)
+        if (_timestamps_enabled or (seg.header().syn and _cfg.timestamps and not receiver_ackno.has_value())) {
+            seg.header().has_timestamps = true;
+            seg.header().tsval = _sender.timestamp();
+            seg.header().tsecr = _receiver.ts_recent().value_or(0);
+        }
+        // as many SACK blocks as fit in the MSS beside the payload: a segment sent before they were reported
+        // may have no room for them all
+        if (_sack_enabled and receiver_ackno.has_value()) {
+            const auto blocks = _receiver.sack_blocks();
+            copy(blocks.begin(), blocks.end(), seg.header().sack_blocks.begin());
+            seg.header().num_sack_blocks = blocks.size();
+            while (seg.header().num_sack_blocks > 0 and
+                   seg.payload().size() + seg.header().options_length() > _sender.mss()) {
+                seg.header().num_sack_blocks--;
+            }
+        }
         _segments_out.push(std::move(seg));
     }
 }
 
+void TCPConnection::_update_options_length() {
+    TCPHeader options;
+    options.has_timestamps = _timestamps_enabled;
+    if (_sack_enabled) {
+        options.num_sack_blocks = _receiver.sack_blocks().size();
+    }
+    _sender.set_options_length(options.options_length());
+}
+
+//! \details The configured MSS, as far as the option's 16 bits can give it
+uint16_t TCPConnection::_advertised_mss() const {
+    return min<size_t>(_cfg.mss.value_or(TCPConfig::MAX_PAYLOAD_SIZE), numeric_limits<uint16_t>::max());
+}
+
+//! \details The least shift that lets the Window field cover the whole receive capacity
+uint8_t TCPConnection::_offered_window_shift() const {
+    uint8_t shift = 0;
+    while (shift < TCPHeader::MAX_WINDOW_SCALE and (_cfg.recv_capacity >> shift) > numeric_limits<uint16_t>::max()) {
+        shift++;
+    }
+    return shift;
+}
+
 bool TCPConnection::_done() const {
     if (not (_receiver.stream_out().eof() or _receiver.stream_out().error())) {
         return false;
@@ -11,7 +11,12 @@ class TCPConnection {
   private:
     TCPConfig _cfg;
     TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPSender _sender{_cfg.send_capacity,
+                      _cfg.rt_timeout,
+                      _cfg.fixed_isn,
+                      CongestionController::make(_cfg),
+                      _cfg.rto_min,
+                      _cfg.rto_max};
 
     //! outbound queue of segments that the TCPConnection wants sent
     std::queue<TCPSegment> _segments_out{};
@@ -25,8 +30,27 @@ class TCPConnection {
     std::optional<size_t> _time_done{};
     bool _active{true};
     bool _rst_set{false};
+    bool _sack_enabled{false};            //!< Did both sides send SACK-permitted on their SYNs?
+    bool _window_scaling_enabled{false};  //!< Did both sides send the window scale option on their SYNs?
+    bool _timestamps_enabled{false};      //!< Did both sides send the timestamps option on their SYNs?
+
+    //! \name Delayed acknowledgments ([RFC 1122](\ref rfc::rfc1122) section 4.2.3.2), once configured
+    //!@{
+    unsigned _segments_unacked{0};  //!< Segments received since an ack was last sent
+    size_t _ack_delay_elapsed{0};   //!< Milliseconds since then
+    //!@}
 
     void _send_outbound_segments();
+    //! Acknowledge again, if reads from the inbound stream have opened the window enough that the peer
+    //! may be waiting for it
+    void _send_window_update();
+    //! Leave room in the sender's segments for the options they'll carry: timestamps, once agreed, and
+    //! the SACK blocks we have to report
+    void _update_options_length();
+    //! The largest segment we can receive, given in the MSS option of our SYN
+    uint16_t _advertised_mss() const;
+    //! The window scale shift count to offer on our SYN ([RFC 7323](\ref rfc::rfc7323))
+    uint8_t _offered_window_shift() const;
     bool _done() const;
     void _check_done();
     void _reset(bool send_rst);
@@ -42,6 +66,23 @@ class TCPConnection {
     //! \returns the number of bytes from `data` that were actually written.
     size_t write(const std::string &data);
 
+    //! \brief Write a refcounted Buffer to the outbound byte stream without copying it
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(Buffer data);
+
+    //! \brief Write a BufferList to the outbound byte stream without copying it
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(const BufferList &data);
+
+    //! \brief Send only full segments until uncork(), to coalesce a run of small writes (like Linux's TCP_CORK)
+    void cork() { _sender.cork(); }
+
+    //! \brief Stop holding back short segments for cork(), and send what can be sent
+    void uncork();
+
+    //! \brief Has cork() been called without a later uncork()?
+    bool corked() const { return _sender.corked(); }
+
     //! \returns the number of `bytes` that can be written right now.
     size_t remaining_outbound_capacity() const;
 
@@ -54,6 +95,10 @@ class TCPConnection {
 
     //! \brief The inbound byte stream received from the peer
     ByteStream &inbound_stream() { return _receiver.stream_out(); }
+
+    //! \brief Tell the connection the owner has read from the inbound stream, so a window the reads opened is
+    //! advertised at once rather than at the next tick
+    void inbound_read();
     //!@}
 
     //! \name Accessors used for testing
@@ -67,6 +112,8 @@ class TCPConnection {
     size_t time_since_last_segment_received() const;
     //!< \brief summarize the state of the sender, receiver, and the connection
     TCPState state() const { return {_sender, _receiver, active(), _linger_after_streams_finish}; };
+    //! \brief the sender's round-trip time estimate and retransmission timeout
+    TCPSenderStats sender_stats() const { return _sender.stats(); }
     //!@}
 
     //! \name Methods for the owner or operating system to call
@@ -78,6 +125,9 @@ class TCPConnection {
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
+    //! \brief How soon tick() will send data the sender is pacing out, in ms, if it's holding any back
+    std::optional<uint64_t> time_until_release() const { return _sender.time_until_release(); }
+
     //! \brief TCPSegments that the TCPConnection has enqueued for transmission.
     //! \note The owner or operating system will dequeue these and
     //! put each one into the payload of a lower-layer datagram (usually Internet datagrams (IP),
@@ -91,7 +141,7 @@ class TCPConnection {
     //!@}
 
     //! Construct a new connection from a configuration
-    explicit TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {}
+    explicit TCPConnection(const TCPConfig &cfg);
 
     //! \name construction and destruction
     //! moving is allowed; copying is disallowed; default construction not possible
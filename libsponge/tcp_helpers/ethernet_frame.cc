@@ -17,8 +17,8 @@ ParseResult EthernetFrame::parse(const Buffer buffer) {
 }
 
 BufferList EthernetFrame::serialize() const {
-    BufferList ret;
-    ret.append(_header.serialize());
-    ret.append(_payload);
+    // the header goes in the payload's headroom if it has any
+    BufferList ret = _payload;
+    _header.serialize(ret.prepend(EthernetHeader::LENGTH));
     return ret;
 }
@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_FD_ADAPTER_HH
 
 #include "file_descriptor.hh"
+#include "ipv4_header.hh"
 #include "lossy_fd_adapter.hh"
 #include "socket.hh"
 #include "tcp_config.hh"
@@ -38,6 +39,10 @@ class FdAdapterBase {
     //! \returns a mutable reference
     FdAdapterConfig &config_mut() { return _cfg; }
 
+    //! \returns the largest payload a TCP segment may carry in an IP datagram of the link's MTU, options included
+    //! \note As [RFC 6691](\ref rfc::rfc6691) has it, a segment's options take room from its payload.
+    size_t max_segment_size() const { return _cfg.mtu - IPv4Header::LENGTH - TCPHeader::LENGTH; }
+
     //! Called periodically when time elapses
     void tick(const size_t) {}
 };
@@ -48,6 +53,8 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
     UDPSocket _sock;
 
   public:
+    static constexpr size_t UDP_HEADER_LENGTH = 8;  //!< [UDP](\ref rfc::rfc768) header length
+
     //! Construct from a UDPSocket sliced into a FileDescriptor
     explicit TCPOverUDPSocketAdapter(UDPSocket &&sock) : _sock(std::move(sock)) {}
 
@@ -57,6 +64,9 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
     //! Writes a TCP segment into a UDP payload
     void write(TCPSegment &seg);
 
+    //! \returns the largest payload a TCP segment may carry in a UDP datagram, within the link's MTU
+    size_t max_segment_size() const { return FdAdapterBase::max_segment_size() - UDP_HEADER_LENGTH; }
+
     //! Access the underlying UDP socket
     operator UDPSocket &() { return _sock; }
 
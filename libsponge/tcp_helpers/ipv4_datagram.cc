@@ -27,15 +27,18 @@ BufferList IPv4Datagram::serialize() const {
 
     IPv4Header header_out = _header;
     header_out.cksum = 0;
-    const string header_zero_checksum = header_out.serialize();
+
+    // the header goes in the payload's headroom if it has any
+    BufferList ret = _payload;
+    const size_t header_len = 4 * header_out.hlen;
+    char *const header_data = ret.prepend(header_len);
+    header_out.serialize(header_data);
 
     // calculate checksum -- taken over header only
     InternetChecksum check;
-    check.add(header_zero_checksum);
+    check.add({header_data, header_len});
     header_out.cksum = check.value();
+    header_out.serialize(header_data);
 
-    BufferList ret;
-    ret.append(header_out.serialize());
-    ret.append(_payload);
     return ret;
 }
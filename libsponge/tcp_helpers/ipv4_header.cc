@@ -2,6 +2,7 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <iomanip>
 #include <sstream>
@@ -76,6 +77,13 @@ ParseResult IPv4Header::parse(NetParser &p) {
 
 //! Serialize the IPv4Header to a string (does not recompute the checksum)
 string IPv4Header::serialize() const {
+    string ret(4 * hlen, 0);
+    serialize(ret.data());
+    return ret;
+}
+
+//! Serialize the IPv4Header into `out` (does not recompute the checksum)
+void IPv4Header::serialize(char *out) const {
     // sanity checks
     if (ver != 4) {
         throw runtime_error("wrong IP version");
@@ -84,29 +92,26 @@ string IPv4Header::serialize() const {
         throw runtime_error("IP header too short");
     }
 
-    string ret;
-    ret.reserve(4 * hlen);
+    char *const end = out + 4 * hlen;
 
     const uint8_t first_byte = (ver << 4) | (hlen & 0xf);
-    NetUnparser::u8(ret, first_byte);  // version and header length
-    NetUnparser::u8(ret, tos);         // type of service
-    NetUnparser::u16(ret, len);        // length
-    NetUnparser::u16(ret, id);         // id
+    NetUnparser::u8(out, first_byte);  // version and header length
+    NetUnparser::u8(out, tos);         // type of service
+    NetUnparser::u16(out, len);        // length
+    NetUnparser::u16(out, id);         // id
 
     const uint16_t fo_val = (df ? 0x4000 : 0) | (mf ? 0x2000 : 0) | (offset & 0x1fff);
-    NetUnparser::u16(ret, fo_val);  // flags and offset
+    NetUnparser::u16(out, fo_val);  // flags and offset
 
-    NetUnparser::u8(ret, ttl);    // time to live
-    NetUnparser::u8(ret, proto);  // protocol number
+    NetUnparser::u8(out, ttl);    // time to live
+    NetUnparser::u8(out, proto);  // protocol number
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::u16(out, cksum);  // checksum
 
-    NetUnparser::u32(ret, src);  // src address
-    NetUnparser::u32(ret, dst);  // dst address
+    NetUnparser::u32(out, src);  // src address
+    NetUnparser::u32(out, dst);  // dst address
 
-    ret.resize(4 * hlen);  // expand header to advertised size
-
-    return ret;
+    fill(out, end, 0);  // expand header to advertised size
 }
 
 uint16_t IPv4Header::payload_length() const { return len - 4 * hlen; }
@@ -7,6 +7,7 @@
 //! \note IP options are not supported
 struct IPv4Header {
     static constexpr size_t LENGTH = 20;         //!< [IPv4](\ref rfc::rfc791) header length, not including options
+    static constexpr size_t MAX_LENGTH = 60;     //!< [IPv4](\ref rfc::rfc791) header length, with the most options
     static constexpr uint8_t DEFAULT_TTL = 128;  //!< A reasonable default TTL value
     static constexpr uint8_t PROTO_TCP = 6;      //!< Protocol number for [tcp](\ref rfc::rfc793)
 
@@ -52,6 +53,9 @@ struct IPv4Header {
     //! Serialize the IP fields
     std::string serialize() const;
 
+    //! Serialize the IP fields into `out`, which must have room for 4 * hlen bytes
+    void serialize(char *out) const;
+
     //! Length of the payload
     uint16_t payload_length() const;
 
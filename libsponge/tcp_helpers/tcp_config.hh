@@ -11,15 +11,63 @@
 //! Config for TCP sender and receiver
 class TCPConfig {
   public:
-    static constexpr size_t DEFAULT_CAPACITY = 64000;  //!< Default capacity
-    static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size for real Internet
-    static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
-    static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    //! \brief Congestion control algorithms for the TCPSender
+    enum class CongestionControl {
+        NewReno,  //!< Slow start, congestion avoidance and fast recovery (RFC 5681, RFC 6582)
+        Cubic,    //!< CUBIC (RFC 8312), leaving slow start by HyStart (RFC 9406)
+        Bbr       //!< BBR: pacing at the measured bottleneck bandwidth, which loss doesn't reduce
+    };
+
+    //! \brief When the TCPSender holds back a segment that lack of data leaves short of the MSS
+    enum class Nagle {
+        Off,      //!< Never: each write goes out at once
+        On,       //!< While any data is unacknowledged (Nagle's algorithm, [RFC 896](\ref rfc::rfc896))
+        Minshall  //!< While an earlier short segment is unacknowledged (Minshall's variant)
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 64000;    //!< Default capacity
+    static constexpr size_t MAX_PAYLOAD_SIZE = 1000;     //!< Conservative max payload size for real Internet
+    static constexpr uint16_t TIMEOUT_DFLT = 1000;       //!< Default re-transmit timeout is 1 second
+    static constexpr uint16_t RTO_MIN_LAN = 200;         //!< RTO floor suited to low-latency paths (as in Linux)
+    static constexpr uint16_t RTO_MAX_DFLT = 60000;      //!< Default ceiling on the RTO estimated from the RTT
+    static constexpr unsigned MAX_RETX_ATTEMPTS = 8;     //!< Maximum re-transmit attempts before giving up
+    static constexpr size_t MAX_INITIAL_WINDOW = 65535;  //!< Largest window that fits an unscaled header
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
+    //! Least retransmission timeout the RTT estimate may give, in ms; if unset, `rt_timeout`
+    //! (the conservative floor of [RFC 6298](\ref rfc::rfc6298), section 2.4)
+    std::optional<uint16_t> rto_min{};
+    uint16_t rto_max = RTO_MAX_DFLT;          //!< Greatest retransmission timeout the RTT estimate may give, in ms
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+    //! Largest payload to send in a segment, advertised in the MSS option of our SYN ([RFC 9293](\ref rfc::rfc9293),
+    //! section 3.7.1); the peer's option may lower it. If unset, TCPSpongeSocket derives it from the adapter's
+    //! MTU, and TCPConnection uses MAX_PAYLOAD_SIZE.
+    std::optional<size_t> mss{};
+    bool sack = true;  //!< Offer (and accept) selective acknowledgments, per [RFC 2018](\ref rfc::rfc2018)
+    bool window_scaling = true;  //!< Offer (and accept) window scaling, per [RFC 7323](\ref rfc::rfc7323)
+    //! Offer (and accept) timestamps, per [RFC 7323](\ref rfc::rfc7323): they time every ack, and protect
+    //! against old duplicates once the sequence numbers wrap (PAWS)
+    bool timestamps = true;
+    //! Delay the ack for in-order data by up to this many ms, unless a second segment arrives or data goes out
+    //! to carry it ([RFC 1122](\ref rfc::rfc1122) section 4.2.3.2 allows 500; Linux waits 40). If unset, every
+    //! segment is acknowledged at once.
+    std::optional<uint16_t> ack_delay{};
+    //! Coalesce small writes into full segments by Nagle's algorithm. Off by default, as waiting on a delayed
+    //! ack can hold a short segment for the whole delay.
+    Nagle nagle = Nagle::Off;
+    bool rack_tlp = true;  //!< Once SACK is negotiated, use RACK-TLP loss detection ([RFC 8985](\ref rfc::rfc8985))
+    CongestionControl congestion_control = CongestionControl::NewReno;  //!< Congestion control algorithm
+    //! Initial congestion window, in bytes. The default, the largest window a peer can advertise without
+    //! window scaling, lets a new connection fill its peer's window in the first round trip as before;
+    //! [RFC 6928](\ref rfc::rfc6928) would use 10 * MAX_PAYLOAD_SIZE.
+    size_t initial_cwnd = MAX_INITIAL_WINDOW;
+    //! Pace new data at `pacing_rate`, or failing that at the congestion controller's rate (BBR gives one),
+    //! rather than sending the whole window at once
+    bool pacing = true;
+    std::optional<double> pacing_rate{};         //!< Fixed pacing rate, in bytes per millisecond
+    size_t pacing_burst = 2 * MAX_PAYLOAD_SIZE;  //!< Bytes a paced sender may send back to back
 };
 
 //! Config for classes derived from FdAdapter
@@ -28,6 +76,8 @@ class FdAdapterConfig {
     Address source{"0", 0};       //!< Source address and port
     Address destination{"0", 0};  //!< Destination address and port
 
+    uint16_t mtu = 1500;  //!< Largest IP datagram the link carries (Ethernet's), from which the MSS follows
+
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
 };
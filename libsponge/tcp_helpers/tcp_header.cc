@@ -1,9 +1,28 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
+namespace {
+
+constexpr size_t MAX_OPTIONS_LENGTH = TCPHeader::MAX_LENGTH - TCPHeader::LENGTH;
+
+//! Length of the options other than SACK, which goes last with as many blocks as fit
+size_t fixed_options_length(const TCPHeader &header) {
+    return (header.mss.has_value() ? 4 : 0) + (header.window_scale.has_value() ? 4 : 0) + (header.sack_permitted ? 4 : 0) +
+           (header.has_timestamps ? TCPHeader::TIMESTAMPS_LENGTH : 0);
+}
+
+//! Number of SACK blocks that fit after the other options
+size_t sack_blocks_that_fit(const TCPHeader &header) {
+    const size_t room = MAX_OPTIONS_LENGTH - fixed_options_length(header);
+    return room < 12 ? 0 : min<size_t>(header.num_sack_blocks, (room - 4) / 8);
+}
+
+}  // namespace
+
 //! \param[in,out] p is a NetParser from which the TCP fields will be extracted
 //! \returns a ParseResult indicating success or the reason for failure
 //! \details It is important to check for (at least) the following potential errors
@@ -14,6 +33,7 @@ using namespace std;
 //! - the header's `doff` field is shorter than the minimum allowed
 //! - there is less data in the header than the `doff` field claims
 //! - the checksum is bad
+//! - an option's length is less than 2, or runs past the end of the header
 ParseResult TCPHeader::parse(NetParser &p) {
     sport = p.u16();                 // source port
     dport = p.u16();                 // destination port
@@ -37,8 +57,57 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // parse the options we know and skip the rest
+    mss.reset();
+    window_scale.reset();
+    has_timestamps = false;
+    sack_permitted = false;
+    num_sack_blocks = 0;
+    size_t options_left = doff * 4 - TCPHeader::LENGTH;
+    while (options_left > 0 and not p.error()) {
+        const uint8_t kind = p.u8();
+        options_left--;
+        if (kind == OPT_EOL) {
+            break;
+        }
+        if (kind == OPT_NOP) {
+            continue;
+        }
+
+        const uint8_t len = options_left > 0 ? p.u8() : 0;
+        if (len < 2 or len - 1u > options_left) {
+            return ParseResult::BadOption;
+        }
+        options_left -= len - 1;
+
+        size_t body = len - 2;
+        if (kind == OPT_MSS and body == 2) {
+            mss = p.u16();
+            body = 0;
+        } else if (kind == OPT_WINDOW_SCALE and body == 1) {
+            window_scale = p.u8();
+            body = 0;
+        } else if (kind == OPT_TIMESTAMPS and body == 8) {
+            has_timestamps = true;
+            tsval = p.u32();
+            tsecr = p.u32();
+            body = 0;
+        } else if (kind == OPT_SACK_PERMITTED) {
+            sack_permitted = true;
+        } else if (kind == OPT_SACK) {
+            for (; body >= 8; body -= 8) {
+                const WrappingInt32 left{p.u32()};
+                const WrappingInt32 right{p.u32()};
+                if (num_sack_blocks < MAX_SACK_BLOCKS) {
+                    sack_blocks[num_sack_blocks++] = {left, right};
+                }
+            }
+        }
+        p.remove_prefix(body);
+    }
+
+    // skip any padding or anything extra in the header
+    p.remove_prefix(options_left);
 
     if (p.error()) {
         return p.get_error();
@@ -49,34 +118,85 @@ ParseResult TCPHeader::parse(NetParser &p) {
 
 //! Serialize the TCPHeader to a string (does not recompute the checksum)
 string TCPHeader::serialize() const {
+    string ret(length(), 0);
+    serialize(ret.data());
+    return ret;
+}
+
+//! Serialize the TCPHeader into `out` (does not recompute the checksum)
+void TCPHeader::serialize(char *out) const {
     // sanity check
     if (doff < 5) {
         throw runtime_error("TCP header too short");
     }
 
-    string ret;
-    ret.reserve(4 * doff);
+    const size_t len = length();
+    char *const end = out + len;
 
-    NetUnparser::u16(ret, sport);              // source port
-    NetUnparser::u16(ret, dport);              // destination port
-    NetUnparser::u32(ret, seqno.raw_value());  // sequence number
-    NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    NetUnparser::u16(out, sport);              // source port
+    NetUnparser::u16(out, dport);              // destination port
+    NetUnparser::u32(out, seqno.raw_value());  // sequence number
+    NetUnparser::u32(out, ackno.raw_value());  // ack number
+    NetUnparser::u8(out, (len / 4) << 4);      // data offset
 
     const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
                          (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
-    NetUnparser::u8(ret, fl_b);  // flags
-    NetUnparser::u16(ret, win);  // window size
+    NetUnparser::u8(out, fl_b);  // flags
+    NetUnparser::u16(out, win);  // window size
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::u16(out, cksum);  // checksum
 
-    NetUnparser::u16(ret, uptr);  // urgent pointer
+    NetUnparser::u16(out, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    // options, each NOP-padded to a 4-byte boundary
+    if (mss.has_value()) {
+        NetUnparser::u8(out, OPT_MSS);
+        NetUnparser::u8(out, 4);
+        NetUnparser::u16(out, mss.value());
+    }
+    if (window_scale.has_value()) {
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_WINDOW_SCALE);
+        NetUnparser::u8(out, 3);
+        NetUnparser::u8(out, window_scale.value());
+    }
+    if (sack_permitted) {
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_SACK_PERMITTED);
+        NetUnparser::u8(out, 2);
+    }
+    if (has_timestamps) {
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_TIMESTAMPS);
+        NetUnparser::u8(out, 10);
+        NetUnparser::u32(out, tsval);
+        NetUnparser::u32(out, tsecr);
+    }
 
-    return ret;
+    const size_t blocks = sack_blocks_that_fit(*this);
+    if (blocks > 0) {
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_NOP);
+        NetUnparser::u8(out, OPT_SACK);
+        NetUnparser::u8(out, 2 + 8 * blocks);
+        for (size_t i = 0; i < blocks; i++) {
+            NetUnparser::u32(out, sack_blocks[i].left.raw_value());
+            NetUnparser::u32(out, sack_blocks[i].right.raw_value());
+        }
+    }
+
+    fill(out, end, 0);  // expand header to advertised size
 }
 
+size_t TCPHeader::options_length() const {
+    const size_t blocks = sack_blocks_that_fit(*this);
+    return fixed_options_length(*this) + (blocks > 0 ? 4 + 8 * blocks : 0);
+}
+
+size_t TCPHeader::length() const { return max<size_t>(4 * doff, LENGTH + options_length()); }
+
 //! \returns A string with the header's contents
 string TCPHeader::to_string() const {
     stringstream ss{};
@@ -90,13 +210,41 @@ string TCPHeader::to_string() const {
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
        << "TCP uptr: " << +uptr << '\n';
+    if (mss.has_value()) {
+        ss << "TCP option: MSS " << dec << mss.value() << hex << '\n';
+    }
+    if (window_scale.has_value()) {
+        ss << "TCP option: window scale " << dec << +window_scale.value() << hex << '\n';
+    }
+    if (sack_permitted) {
+        ss << "TCP option: SACK permitted\n";
+    }
+    if (has_timestamps) {
+        ss << "TCP option: timestamps " << dec << tsval << " " << tsecr << hex << '\n';
+    }
+    for (size_t i = 0; i < num_sack_blocks; i++) {
+        ss << "TCP option: SACK " << sack_blocks[i].left << "-" << sack_blocks[i].right << '\n';
+    }
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win;
+    if (mss.has_value()) {
+        ss << ",mss=" << mss.value();
+    }
+    if (window_scale.has_value()) {
+        ss << ",wscale=" << +window_scale.value();
+    }
+    if (has_timestamps) {
+        ss << ",ts=" << tsval << "/" << tsecr;
+    }
+    for (size_t i = 0; i < num_sack_blocks; i++) {
+        ss << (i == 0 ? ",sack=" : " ") << sack_blocks[i].left << "-" << sack_blocks[i].right;
+    }
+    ss << ")";
     return ss.str();
 }
 
@@ -104,5 +252,13 @@ bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && mss == other.mss && window_scale == other.window_scale &&
+           has_timestamps == other.has_timestamps &&
+           (not has_timestamps || (tsval == other.tsval && tsecr == other.tsecr)) &&
+           sack_permitted == other.sack_permitted &&
+           num_sack_blocks == other.num_sack_blocks &&
+           equal(sack_blocks.begin(),
+                 sack_blocks.begin() + num_sack_blocks,
+                 other.sack_blocks.begin(),
+                 [](const SackBlock &a, const SackBlock &b) { return a.left == b.left && a.right == b.right; });
 }
@@ -4,10 +4,36 @@
 #include "parser.hh"
 #include "wrapping_integers.hh"
 
+#include <array>
+#include <optional>
+
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note The maximum segment size, window scale and timestamps ([RFC 7323](\ref rfc::rfc7323)),
+//! SACK-permitted and SACK ([RFC 2018](\ref rfc::rfc2018)) options are supported; others are skipped
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;      //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t MAX_LENGTH = 60;  //!< [TCP](\ref rfc::rfc793) header length, with the most options
+
+    //! \name Option kinds
+    //!@{
+    static constexpr uint8_t OPT_EOL = 0;             //!< end of option list
+    static constexpr uint8_t OPT_NOP = 1;             //!< no-operation (padding)
+    static constexpr uint8_t OPT_MSS = 2;             //!< maximum segment size, sent on SYNs
+    static constexpr uint8_t OPT_WINDOW_SCALE = 3;    //!< window scale shift count, sent on SYNs
+    static constexpr uint8_t OPT_SACK_PERMITTED = 4;  //!< SACK-permitted, sent on SYNs
+    static constexpr uint8_t OPT_SACK = 5;            //!< selective acknowledgment blocks
+    static constexpr uint8_t OPT_TIMESTAMPS = 8;      //!< timestamp value and echo reply
+    //!@}
+
+    static constexpr size_t MAX_SACK_BLOCKS = 4;     //!< The most SACK blocks that fit in the options area
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14;  //!< Largest window scale shift count RFC 7323 allows
+    static constexpr size_t TIMESTAMPS_LENGTH = 12;  //!< Room the timestamps option takes, padding included
+
+    //! \brief A block of received sequence space, [left, right), reported in the SACK option
+    struct SackBlock {
+        WrappingInt32 left{0};   //!< first sequence number of the block
+        WrappingInt32 right{0};  //!< sequence number just past the block
+    };
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -33,11 +59,16 @@ struct TCPHeader {
     //! ~~~
 
     //! \name TCP Header fields
+    //! \note The fields (options included) are declared in the order that leaves the least padding between
+    //! them: segments are queued by value, and a smaller header lets a queue node hold more of them.
     //!@{
     uint16_t sport = 0;         //!< source port
     uint16_t dport = 0;         //!< destination port
     WrappingInt32 seqno{0};     //!< sequence number
     WrappingInt32 ackno{0};     //!< ack number
+    uint16_t win = 0;           //!< window size
+    uint16_t cksum = 0;         //!< checksum
+    uint16_t uptr = 0;          //!< urgent pointer
     uint8_t doff = LENGTH / 4;  //!< data offset
     bool urg = false;           //!< urgent flag
     bool ack = false;           //!< ack flag
@@ -45,17 +76,36 @@ struct TCPHeader {
     bool rst = false;           //!< rst flag
     bool syn = false;           //!< syn flag
     bool fin = false;           //!< fin flag
-    uint16_t win = 0;           //!< window size
-    uint16_t cksum = 0;         //!< checksum
-    uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! \name TCP options
+    //!@{
+    bool sack_permitted = false;                            //!< SACK-permitted option present
+    bool has_timestamps = false;                            //!< timestamps option present
+    std::optional<uint8_t> window_scale{};                  //!< window scale option's shift count, if present
+    uint8_t num_sack_blocks = 0;                            //!< number of valid entries in `sack_blocks`
+    std::optional<uint16_t> mss{};                          //!< maximum segment size option's value, if present
+    uint32_t tsval = 0;                                     //!< timestamps option's TSval: the sender's clock
+    uint32_t tsecr = 0;                                     //!< timestamps option's TSecr: the TSval echoed
+    std::array<SackBlock, MAX_SACK_BLOCKS> sack_blocks{};  //!< SACK option blocks, in the order sent
+    //!@}
+
+    //! \brief Length of the options serialize() writes, padded to a multiple of 4
+    //! \note SACK blocks that don't fit beside the other options are left out
+    size_t options_length() const;
+
+    //! \brief Length of the header serialize() writes: 4 * doff, or more if needed to hold the options
+    size_t length() const;
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
     //! Serialize the TCP fields
     std::string serialize() const;
 
+    //! Serialize the TCP fields into `out`, which must have room for length() bytes
+    void serialize(char *out) const;
+
     //! Return a string containing a header in human-readable format
     std::string to_string() const;
 
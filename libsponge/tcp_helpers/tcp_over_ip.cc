@@ -71,6 +71,10 @@ optional<TCPSegment> TCPOverIPv4Adapter::unwrap_tcp_in_ip(const InternetDatagram
 }
 
 //! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
+//! \details The TCP, IPv4 and Ethernet layers each write their header into headroom in front of the payload,
+//! so the finished packet is a single contiguous Buffer that goes out in one single-iovec write. A payload
+//! that no other Buffer refers to, with PACKET_HEADROOM bytes of headroom, takes the headers in place;
+//! any other payload is first copied once, into a packet buffer with that much headroom.
 //! \param[in] seg is the TCP segment to convert
 InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
     // set the port numbers in the TCP segment
@@ -81,10 +85,21 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip(TCPSegment &seg) {
     InternetDatagram ip_dgram;
     ip_dgram.header().src = config().source.ipv4_numeric();
     ip_dgram.header().dst = config().destination.ipv4_numeric();
-    ip_dgram.header().len = ip_dgram.header().hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+    ip_dgram.header().len = ip_dgram.header().hlen * 4 + seg.header().length() + seg.payload().size();
+
+    TCPSegment packet_seg;
+    packet_seg.header() = seg.header();
+    const Buffer &payload = seg.payload();
+    if (not payload.shared() and payload.can_prepend(PACKET_HEADROOM)) {
+        packet_seg.payload() = payload;
+    } else {
+        // copy the TCP payload into a packet buffer with room for the headers
+        packet_seg.payload() = Buffer::allocate(payload.size(), PACKET_HEADROOM);
+        payload.str().copy(packet_seg.payload().mutable_data(), payload.size());
+    }
 
     // set payload, calculating TCP checksum using information from IP header
-    ip_dgram.payload() = seg.serialize(ip_dgram.header().pseudo_cksum());
+    ip_dgram.payload() = packet_seg.serialize(ip_dgram.header().pseudo_cksum());
 
     return ip_dgram;
 }
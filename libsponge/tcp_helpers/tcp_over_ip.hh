@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_TCP_OVER_IP_HH
 
 #include "buffer.hh"
+#include "ethernet_header.hh"
 #include "fd_adapter.hh"
 #include "ipv4_datagram.hh"
 #include "tcp_segment.hh"
@@ -11,6 +12,9 @@
 //! \brief A converter from TCP segments to serialized IPv4 datagrams
 class TCPOverIPv4Adapter : public FdAdapterBase {
   public:
+    //! Room reserved in front of each outgoing payload for its TCP, IPv4 and (if any) Ethernet headers
+    static constexpr size_t PACKET_HEADROOM = TCPHeader::MAX_LENGTH + IPv4Header::MAX_LENGTH + EthernetHeader::LENGTH;
+
     std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
 
     InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
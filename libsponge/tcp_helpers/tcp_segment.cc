@@ -31,15 +31,18 @@ BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
     TCPHeader header_out = _header;
     header_out.cksum = 0;
 
+    // the header goes in the payload's headroom if it has any
+    BufferList ret{_payload};
+    char *const header_data = ret.prepend(header_out.length());
+    header_out.serialize(header_data);
+
     // calculate checksum -- taken over entire segment
     InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
+    for (const auto &buf : ret.buffers()) {
+        check.add(buf);
+    }
     header_out.cksum = check.value();
-
-    BufferList ret;
-    ret.append(header_out.serialize());
-    ret.append(_payload);
+    header_out.serialize(header_data);
 
     return ret;
 }
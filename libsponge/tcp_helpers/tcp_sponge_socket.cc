@@ -5,9 +5,12 @@
 #include "tun.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <sys/socket.h>
@@ -25,10 +28,14 @@ template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     auto base_time = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        // wake for the pacer's next release, if it's sooner than the next tick
+        const auto release = _tcp.value().time_until_release();
+        const auto timeout = min(release.value_or(TCP_TICK_MS), uint64_t{TCP_TICK_MS});
+        auto ret = _eventloop.wait_next_event(static_cast<int>(timeout));
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
+        _follow_cork();
 
         if (_tcp.value().active()) {
             const auto next_time = timestamp_ms();
@@ -39,6 +46,16 @@ void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     }
 }
 
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_follow_cork() {
+    const bool corked = _corked.load();
+    if (corked and not _tcp->corked()) {
+        _tcp->cork();
+    } else if (not corked and _tcp->corked()) {
+        _tcp->uncork();
+    }
+}
+
 //! \param[in] data_socket_pair is a pair of connected AF_UNIX SOCK_STREAM sockets
 //! \param[in] datagram_interface is the interface for reading and writing datagrams
 template <typename AdaptT>
@@ -52,7 +69,10 @@ TCPSpongeSocket<AdaptT>::TCPSpongeSocket(pair<FileDescriptor, FileDescriptor> da
 
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
-    _tcp.emplace(config);
+    // segments must fit the adapter's MTU; unless configured smaller, they are as big as it allows
+    TCPConfig tcp_config = config;
+    tcp_config.mss = min(config.mss.value_or(numeric_limits<size_t>::max()), _datagram_adapter.max_segment_size());
+    _tcp.emplace(tcp_config);
 
     // Set up the event loop
 
@@ -96,9 +116,11 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
+            // data written after cork() is held back with what's already buffered
+            _follow_cork();
+            auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
             const auto len = data.size();
-            const auto amount_written = _tcp->write(move(data));
+            const auto amount_written = _tcp->write(Buffer{move(data)});
             if (amount_written != len) {
                 throw runtime_error("TCPConnection::write() accepted less than advertised length");
             }
@@ -129,9 +151,9 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
             // the pipe, handling the possibility of a partial
             // write (i.e., only pop what was actually written).
             const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
+            const auto bytes_written = _thread_data.write(inbound.peek_output_view(amount_to_write), false);
             inbound.pop_output(bytes_written);
+            _tcp->inbound_read();
 
             if (inbound.eof() or inbound.error()) {
                 _thread_data.shutdown(SHUT_WR);
@@ -208,10 +230,10 @@ void TCPSpongeSocket<AdaptT>::connect(const TCPConfig &c_tcp, const FdAdapterCon
         throw runtime_error("connect() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
-
     _datagram_adapter.config_mut() = c_ad;
 
+    _initialize_TCP(c_tcp);
+
     cerr << "DEBUG: Connecting to " << c_ad.destination.to_string() << "...\n";
     _tcp->connect();
 
@@ -236,9 +258,9 @@ void TCPSpongeSocket<AdaptT>::listen_and_accept(const TCPConfig &c_tcp, const Fd
         throw runtime_error("listen_and_accept() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
-
     _datagram_adapter.config_mut() = c_ad;
+
+    _initialize_TCP(c_tcp);
     _datagram_adapter.set_listening(true);
 
     cerr << "DEBUG: Listening for incoming connection...\n";
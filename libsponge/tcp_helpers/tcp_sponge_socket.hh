@@ -57,6 +57,11 @@ class TCPSpongeSocket : public LocalStreamSocket {
 
     bool _fully_acked{false};  //!< Has the outbound data been fully acknowledged by the peer?
 
+    std::atomic_bool _corked{false};  //!< Has the owner corked the connection? The TCPConnection thread follows
+
+    //! Cork or uncork the TCPConnection as the owner last asked
+    void _follow_cork();
+
   public:
     //! Construct from the interface that the TCPConnection thread will use to read and write datagrams
     explicit TCPSpongeSocket(AdaptT &&datagram_interface);
@@ -72,6 +77,13 @@ class TCPSpongeSocket : public LocalStreamSocket {
     //! Listen and accept using the specified configurations; blocks until accept succeeds or fails
     void listen_and_accept(const TCPConfig &c_tcp, const FdAdapterConfig &c_ad);
 
+    //! \brief Send only full segments until uncork(), so a run of small writes goes out coalesced
+    //! \note Writes made after cork() returns are held back.
+    void cork() { _corked.store(true); }
+
+    //! \brief Send what cork() held back, within one tick of the TCPConnection thread
+    void uncork() { _corked.store(false); }
+
     //! When a connected socket is destructed, it will send a RST
     ~TCPSpongeSocket();
 
@@ -21,7 +21,7 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
     //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
     std::optional<TCPSegment> read() {
         InternetDatagram ip_dgram;
-        if (ip_dgram.parse(_tun.read()) != ParseResult::NoError) {
+        if (ip_dgram.parse(_tun.read_buffer()) != ParseResult::NoError) {
             return {};
         }
         return unwrap_tcp_in_ip(ip_dgram);
@@ -1,5 +1,8 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+#include <limits>
+
 // Dummy implementation of a TCP receiver
 
 // For Lab 2, please replace with a real implementation that passes the
@@ -7,12 +10,25 @@
 
 using namespace std;
 
-void TCPReceiver::segment_received(const TCPSegment &seg) {
+bool TCPReceiver::segment_received(const TCPSegment &seg) {
     auto seqno = seg.header().seqno;
     auto syn = seg.header().syn;
     auto fin = seg.header().fin;
     const auto &payload = seg.payload();
 
+    if (_timestamps and seg.header().has_timestamps) {
+        const uint32_t tsval = seg.header().tsval;
+        const auto last_ackno = ackno();
+        if (not syn and _ts_recent.has_value() and static_cast<int32_t>(tsval - _ts_recent.value()) < 0) {
+            return false;
+        }
+        // only a segment at or below the ackno last sent may update TS.Recent: one further on may have
+        // arrived early, and its TSval would hide the delay of the segments yet to fill the gap
+        if (syn or not last_ackno.has_value() or seqno - last_ackno.value() <= 0) {
+            _ts_recent = tsval;
+        }
+    }
+
     [[unlikely]] if (syn) {
         // SYN received
         _sender_isn = seqno;
@@ -24,13 +40,14 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
             // SYN segment may also contain data payload
             abs_seqno = 1;
             if (!syn) {
-                return; // invalid stream with index 0
+                return true; // invalid stream with index 0
             }
         }
 
         size_t stream_index = abs_seqno - 1;
-        _reassembler.push_substring(payload.copy(), stream_index, fin);
+        _reassembler.push_substring(payload, stream_index, fin);
     } // otherwise, it's in LISTEN
+    return true;
 }
 
 optional<WrappingInt32> TCPReceiver::ackno() const {
@@ -47,4 +64,53 @@ optional<WrappingInt32> TCPReceiver::ackno() const {
     return wrap(abs_seqno, _sender_isn.value());
 }
 
-size_t TCPReceiver::window_size() const { return _reassembler.stream_out().remaining_capacity(); }
+size_t TCPReceiver::window_size() const {
+    const size_t remaining = _reassembler.stream_out().remaining_capacity();
+    size_t window = remaining;
+    // short of a full step, keep the right edge where it was: the peer would only fill the sliver with a
+    // small segment
+    bool edge_kept = false;
+    if (_sws_threshold.has_value()) {
+        const uint64_t next = _reassembler.stream_out().bytes_written();
+        const size_t offered = _window_right > next ? _window_right - next : 0;
+        if (window < offered + _sws_threshold.value()) {
+            window = min(window, offered);
+            edge_kept = true;
+        }
+    }
+    if (_window_shift == 0) {
+        return window;
+    }
+    const size_t largest = size_t{numeric_limits<uint16_t>::max()} << _window_shift;
+    window = min(window, largest);
+    // rounding a kept window down would pull its edge back a little with each ack; round it up, if there's room
+    const size_t unit = size_t{1} << _window_shift;
+    const size_t rounded_up = (window + unit - 1) >> _window_shift << _window_shift;
+    if (edge_kept and rounded_up <= min(remaining, largest)) {
+        return rounded_up;
+    }
+    return window >> _window_shift << _window_shift;
+}
+
+bool TCPReceiver::window_opened() const {
+    if (not _sws_threshold.has_value()) {
+        return false;
+    }
+    const uint64_t next = _reassembler.stream_out().bytes_written();
+    const size_t offered = _window_right > next ? _window_right - next : 0;
+    const size_t window = window_size();
+    return window > offered and window >= 2 * offered;
+}
+
+SmallVector<TCPHeader::SackBlock, TCPHeader::MAX_SACK_BLOCKS> TCPReceiver::sack_blocks() const {
+    SmallVector<TCPHeader::SackBlock, TCPHeader::MAX_SACK_BLOCKS> ret;
+    if (not _sender_isn.has_value()) {
+        return ret;
+    }
+
+    // stream index i is absolute seqno i + 1 (the SYN takes up seqno 0)
+    for (const auto &[begin, end] : _reassembler.stored_ranges(TCPHeader::MAX_SACK_BLOCKS)) {
+        ret.push_back({wrap(begin + 1, _sender_isn.value()), wrap(end + 1, _sender_isn.value())});
+    }
+    return ret;
+}
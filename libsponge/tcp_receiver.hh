@@ -6,6 +6,7 @@
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <optional>
 
 //! \brief The "receiver" part of a TCP implementation.
@@ -23,6 +24,21 @@ class TCPReceiver {
     //! The initial sequence number of sender
     std::optional<WrappingInt32> _sender_isn{};
 
+    //! The window scale shift count ([RFC 7323](\ref rfc::rfc7323)) the window is advertised with
+    uint8_t _window_shift{0};
+
+    //! \name Silly window syndrome avoidance ([RFC 1122](\ref rfc::rfc1122) section 4.2.3.3), once enabled
+    //!@{
+    std::optional<size_t> _sws_threshold{};  //!< Least step the window's right edge moves by
+    uint64_t _window_right{0};               //!< Stream index just past the window last advertised
+    //!@}
+
+    //! \name Timestamps ([RFC 7323](\ref rfc::rfc7323)), once agreed
+    //!@{
+    bool _timestamps{false};                //!< Segments carry timestamps, and old ones are rejected (PAWS)
+    std::optional<uint32_t> _ts_recent{};  //!< TS.Recent: the TSval to echo, from the latest in-order segment
+    //!@}
+
   public:
     //! \brief Construct a TCP receiver
     //!
@@ -50,14 +66,51 @@ class TCPReceiver {
     //! the first byte that falls after the window (and will not be
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
+    //!
+    //! Once window scaling is enabled, the window is limited to what the 16-bit Window field can
+    //! carry at that scale, and rounded down to a multiple of the scale, so the peer sees it whole.
+    //!
+    //! Once silly window syndrome avoidance is enabled, the window's right edge stays where it was last
+    //! advertised until it can move by a full step.
     size_t window_size() const;
+
+    //! \brief Open the window only in steps of an MSS (`mss`), or half the capacity if that's smaller
+    void enable_sws_avoidance(const size_t mss) { _sws_threshold = std::min(mss, _capacity / 2); }
+
+    //! \brief Record that the window, of `window` bytes, has been advertised to the peer
+    void window_advertised(const size_t window) { _window_right = stream_out().bytes_written() + window; }
+
+    //! \brief Has reading from the stream opened the window enough to tell the peer without waiting for data?
+    //! \details Once silly window syndrome avoidance is enabled, that's when the window has moved by a step,
+    //! and is at least twice what's left of the one last advertised.
+    bool window_opened() const;
+
+    //! \brief Advertise the window scaled down by `shift` bits, once window scaling is agreed
+    void enable_window_scaling(const uint8_t shift) { _window_shift = shift; }
+
+    //! \brief The window scale shift count the window is advertised with (0 if unscaled)
+    uint8_t window_shift() const { return _window_shift; }
+
+    //! \brief Take timestamps from the segments received, and reject those older than the last taken
+    void enable_timestamps() { _timestamps = true; }
+
+    //! \brief The timestamp to echo to the peer (TSecr), if one has been taken
+    std::optional<uint32_t> ts_recent() const { return _ts_recent; }
+
+    //! \brief The [SACK](\ref rfc::rfc2018) blocks that should be sent to the peer
+    //! \details One block per run of out-of-order bytes held by the reassembler, the runs
+    //! with the most recently received data first, listed in sequence order.
+    //! \returns no blocks if no SYN has been received or nothing is out of order
+    SmallVector<TCPHeader::SackBlock, TCPHeader::MAX_SACK_BLOCKS> sack_blocks() const;
     //!@}
 
     //! \brief number of bytes stored but not yet reassembled
     size_t unassembled_bytes() const { return _reassembler.unassembled_bytes(); }
 
     //! \brief handle an inbound segment
-    void segment_received(const TCPSegment &seg);
+    //! \returns false if the segment was rejected as an old duplicate: once timestamps are enabled, one whose
+    //! TSval is older than TS.Recent (PAWS, [RFC 7323](\ref rfc::rfc7323) section 5)
+    bool segment_received(const TCPSegment &seg);
 
     //! \name "Output" interface for the reader
     //!@{
@@ -2,6 +2,8 @@
 
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 // Dummy implementation of a TCP sender
@@ -14,18 +16,48 @@ using namespace std;
 //! \param[in] capacity the capacity of the outgoing byte stream
 //! \param[in] retx_timeout the initial amount of time to wait before retransmitting the oldest outstanding segment
 //! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise uses a random ISN)
-TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
+//! \param[in] congestion_controller the congestion control algorithm (if empty, the TCPConfig default)
+//! \param[in] rto_min the least retransmission timeout the RTT estimate may give (if unset, `retx_timeout`)
+//! \param[in] rto_max the greatest retransmission timeout the RTT estimate may give
+TCPSender::TCPSender(const size_t capacity,
+                     const uint16_t retx_timeout,
+                     const std::optional<WrappingInt32> fixed_isn,
+                     unique_ptr<CongestionController> congestion_controller,
+                     const optional<uint16_t> rto_min,
+                     const uint16_t rto_max)
     : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
-    , _initial_retransmission_timeout{retx_timeout}
+    , _rtt(retx_timeout, rto_min.value_or(retx_timeout), rto_max)
     , _stream(capacity)
-    , _retransmission_timeout{retx_timeout} {}
+    , _retransmission_timeout{retx_timeout}
+    , _congestion(congestion_controller ? move(congestion_controller) : CongestionController::make({})) {}
 
-uint64_t TCPSender::bytes_in_flight() const {
-    uint64_t bytes = 0;
-    for (auto& seg : _segments_pending) {
-        bytes += seg.length_in_sequence_space();
-    }
-    return bytes;
+void TCPSender::set_mss(const size_t mss) {
+    _mss = mss;
+    _congestion->set_mss(mss);
+}
+
+uint64_t TCPSender::bytes_in_flight() const { return _bytes_in_flight; }
+
+TCPSenderStats TCPSender::stats() const {
+    return {_rtt.srtt(),
+            _rtt.rttvar(),
+            _rtt.min_rtt(),
+            _rtt.latest_rtt(),
+            _rtt.samples(),
+            _retransmission_timeout,
+            _tlp_probes,
+            _rack_losses,
+            _window_probes};
+}
+
+uint64_t TCPSender::_receiver_window_remaining() const {
+    return _receiver_window_right - min(_receiver_window_right, _next_seqno);
+}
+
+uint64_t TCPSender::_send_window_remaining() const {
+    const uint64_t cwnd = _congestion->cwnd();
+    const uint64_t pipe = _pipe();
+    return min(_receiver_window_remaining(), cwnd - min(cwnd, pipe));
 }
 
 void TCPSender::fill_window() {
@@ -37,107 +69,625 @@ void TCPSender::fill_window() {
         return;
     }
 
-    size_t receiver_window_remaining = _receiver_window_right - next_seqno_absolute();
-    size_t payload_len_limit = min(receiver_window_remaining, TCPConfig::MAX_PAYLOAD_SIZE);
+    // the window is the smaller of the receiver's and the congestion window
+    size_t window_remaining = _send_window_remaining();
+    size_t payload_len_limit = min(window_remaining, _max_payload());
 
-    // fill receiver's window as much as possible, may send out multiple segments
+    // fill the window as much as possible, may send out multiple segments
     while (payload_len_limit > 0 and not _fined) {
-        string payload = _stream.read(payload_len_limit);
-        builder.with_seqno(next_seqno()).with_data(payload);
+        // a paced sender holds back what's left until the pacer has tokens for it
+        const bool more_to_send = not _stream.buffer_empty() or _stream.eof();
+        if (_pacer.has_value() and more_to_send and not _pacer->may_send()) {
+            break;
+        }
+        // a segment the congestion window would cut short waits for it to open further, while acks for what's
+        // in flight are on their way to open it (sender-side silly window avoidance, [RFC 1122](\ref rfc::rfc1122)
+        // section 4.2.3.4; the receiver's own avoidance keeps its window from being cut that fine)
+        const uint64_t uncut = min<uint64_t>({_receiver_window_remaining(), _stream.buffer_size(), _max_payload()});
+        if (payload_len_limit < uncut and _bytes_in_flight > 0) {
+            break;
+        }
+        // a segment that would be short for want of data may wait for more, unless it's the stream's last
+        if (_stream.buffer_size() < _max_payload() and not _stream.input_ended() and _holds_short_segment()) {
+            break;
+        }
+
+        // the payload is a slice of the stream's storage, shared by _segments_out and _segments_pending
+        Buffer payload = _stream.read_buffer(payload_len_limit);
+        const size_t payload_size = payload.size();
+        builder.with_seqno(next_seqno()).with_data(move(payload));
 
         // _stream buffer empty
-        if (payload.empty() and not _stream.eof()) {
+        if (payload_size == 0 and not _stream.eof()) {
             break;
         }
 
-        if (not _stream.eof() and not payload.empty()) {
+        if (not _stream.eof() and payload_size > 0) {
             // no need to set fin
             _send(builder);
         } else if (_stream.eof()) {
             // if length is limited by the receiver window, don't send fin
-            // else, receiver has enough room for fin, but length is limited by MAX_PAYLOAD_SIZE, send fin
-            if (payload.size() < payload_len_limit) {
+            // else, receiver has enough room for fin, but length is limited by the MSS, send fin
+            if (payload_size < payload_len_limit) {
                 builder.with_fin(); // notify fin while carry payload; payload can be empty
                 _fined = true;
-            } else if (receiver_window_remaining > payload_len_limit) {
+            } else if (window_remaining > payload_len_limit) {
                 builder.with_fin(); // fin flag won't take payload's space, though take 1 for abs_seqno
                 _fined = true;
             }
             _send(builder);
         }
 
-        // update remaining receiver window
-        receiver_window_remaining = _receiver_window_right - next_seqno_absolute();
-        payload_len_limit = min(receiver_window_remaining, TCPConfig::MAX_PAYLOAD_SIZE);
+        // update remaining window
+        window_remaining = _send_window_remaining();
+        payload_len_limit = min(window_remaining, _max_payload());
+    }
+
+    // out of data with room to spare: rate samples from now on don't show what the path can do
+    if (_stream.buffer_empty() and _pipe() < _congestion->cwnd() and _lost_bytes <= _retransmitted_bytes) {
+        _app_limited = max<uint64_t>(_delivered + _pipe(), 1);
+    }
+    _update_persist_timer();
+}
+
+//! \details At least one byte, however much room options take.
+size_t TCPSender::_max_payload() const { return _mss - min(_mss - 1, _options_length); }
+
+//! \details Corked, always. Otherwise, by Nagle's algorithm, while any data is unacknowledged; by Minshall's
+//! variant, only while an earlier short segment is, so the short tail of a bulk transfer isn't held back.
+bool TCPSender::_holds_short_segment() const {
+    if (_corked) {
+        return true;
     }
+    switch (_nagle) {
+        case TCPConfig::Nagle::Off:
+            return false;
+        case TCPConfig::Nagle::On:
+            return _bytes_in_flight > 0;
+        case TCPConfig::Nagle::Minshall:
+            return _short_segment_end > _receiver_window_left;
+    }
+    return false;
+}
+
+uint64_t TCPSender::_pipe() const {
+    const uint64_t unsacked = _bytes_in_flight - _sacked_bytes - _lost_bytes;
+    // a duplicate ack can only stand for a segment that is outstanding
+    const uint64_t dup_acked = min<uint64_t>(_dup_acks * _mss, unsacked);
+    return unsacked - dup_acked + _retransmitted_bytes;
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
 //! \param window_size The remote receiver's advertised window size
+//! \details The segment this came on isn't known to carry nothing else, so it isn't counted as a duplicate ack.
 void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+    _ack_received(ackno, window_size, false);
+}
+
+//! \param segment The segment carrying the acknowledgment
+void TCPSender::ack_received(const TCPSegment &segment) {
+    const TCPHeader &header = segment.header();
+    _rate_sample_start.reset();
+    _update_scoreboard(header);
+    // the window on a SYN is never scaled
+    const uint64_t window_size = header.syn ? header.win : uint64_t{header.win} << _window_shift;
+    optional<uint64_t> echo_rtt{};
+    if (_timestamps and header.has_timestamps) {
+        echo_rtt = static_cast<uint32_t>(timestamp() - header.tsecr);
+    }
+    _ack_received(header.ackno,
+                  window_size,
+                  segment.length_in_sequence_space() == 0 and header.num_sack_blocks == 0,
+                  echo_rtt);
+}
+
+void TCPSender::_ack_received(const WrappingInt32 ackno,
+                              const uint64_t window_size,
+                              const bool may_be_duplicate,
+                              const optional<uint64_t> echo_rtt) {
     auto absolute_ackno = unwrap(ackno, _isn, _receiver_window_left);
+    const bool window_was_zero = zero_window_size;
     if (window_size == 0) {
         zero_window_size = true;
     } else {
         zero_window_size = false;
     }
-    if (absolute_ackno > _receiver_window_right) {
+    if (_probe_outstanding and absolute_ackno == _next_seqno + 1) {
+        _take_window_probe();
+    }
+    // an ack for data never sent is ignored
+    if (absolute_ackno > _next_seqno) {
         return;
     }
+    // a peer that answers probes of its zero window, or opens it, is still there: only unanswered probes
+    // count towards giving up ([RFC 1122](\ref rfc::rfc1122) section 4.2.2.17)
+    if (_persist and (zero_window_size or window_was_zero)) {
+        _consecutive_retransmissions = 0;
+    }
 
     if (absolute_ackno > _receiver_window_left) {
+        // the congestion controller only hears about data (the SYN's sequence number doesn't count)
+        const uint64_t newly_acked = absolute_ackno - max<uint64_t>(_receiver_window_left, 1);
+
         // update receiver window
-        _receiver_window_size = zero_window_size ? 1 : window_size;
+        _receiver_window_size = zero_window_size and not _persist ? 1 : window_size;
         _receiver_window_left = absolute_ackno;
         _receiver_window_right = absolute_ackno + _receiver_window_size;
 
-        // reset timeout
-        _retransmission_timeout = _initial_retransmission_timeout;
         _consecutive_retransmissions = 0;
 
-        // receiver has received all the segments on the left of _receiver_window_left
-        while (not _segments_pending.empty()) {
-            TCPSegment &seg = _segments_pending.front();
-            auto absolute_seqno = unwrap(seg.header().seqno, _isn, _receiver_window_left);
-            if (absolute_seqno + seg.length_in_sequence_space() <= _receiver_window_left) {
-                _segments_pending.pop_front();
-            } else {
-                break;
+        // receiver has received all the segments on the left of _receiver_window_left; the newest of them
+        // gives an RTT sample, unless it was retransmitted (Karn's algorithm) or the ack echoes a timestamp
+        optional<uint64_t> rtt{};
+        size_t segments_acked = 0;
+        while (not _segments_pending.empty() and _segments_pending.front().end() <= _receiver_window_left) {
+            const OutstandingSegment &acked = _segments_pending.front();
+            rtt = acked.transmissions == 1 ? optional<uint64_t>{_time_ms - acked.sent_time} : nullopt;
+            if (not acked.sacked) {
+                _on_delivered(acked);
+            }
+            _account(_segments_pending.front(), -1);
+            _bytes_in_flight -= _segments_pending.front().segment.length_in_sequence_space();
+            _segments_pending.pop_front();
+            segments_acked++;
+        }
+        if (echo_rtt.has_value()) {
+            rtt = echo_rtt;
+        }
+        if (rtt.has_value()) {
+            _rtt.sample(rtt.value());
+        }
+        // new data was acknowledged: drop any backoff
+        _retransmission_timeout = _rtt.rto();
+
+        // loss recovery is over once everything outstanding when it began has been acknowledged
+        if (_recovery_point.has_value() and _receiver_window_left >= _recovery_point.value()) {
+            _recovery_point.reset();
+            _fast_recovery = false;
+            for (auto &pending : _segments_pending) {
+                _account(pending, -1);
+                pending.lost = pending.retransmitted = false;
+                _account(pending, 1);
             }
         }
 
-        // reset timer
-        if (_segments_pending.empty()) {
-            _timer.stop();
+        // in fast recovery, the first segment acknowledged filled a hole; the rest arrived earlier,
+        // and the duplicate acks that stood for them leave with them
+        if (_fast_recovery) {
+            _dup_acks -= min<unsigned>(_dup_acks, segments_acked - 1);
         } else {
-            _timer.start(_retransmission_timeout);
+            _dup_acks = 0;
+        }
+
+        const auto sample = _take_rate_sample();
+        if (newly_acked > 0 or sample.has_value()) {
+            _congestion->on_ack({_time_ms,
+                                 absolute_ackno,
+                                 _next_seqno,
+                                 newly_acked,
+                                 _bytes_in_flight,
+                                 rtt,
+                                 _delivered,
+                                 sample,
+                                 _pipe()});
+        }
+
+        // the loss probe's episode is over once it's acknowledged. Without DSACK there's no telling whether
+        // a resent probe repaired a loss or was a needless copy, so that is taken as a loss (RFC 8985 7.4.2),
+        // reducing the window the probe went out under: little is left in flight once it's acknowledged.
+        if (_tlp_end.has_value() and _receiver_window_left >= _tlp_end.value()) {
+            if (_tlp_retransmitted and not _recovery_point.has_value()) {
+                _congestion->on_loss(_time_ms, _congestion->cwnd(), _next_seqno, _pipe());
+            }
+            _tlp_end.reset();
+        }
+
+        _restart_timer();
+
+        // a partial ack in fast recovery points at the next hole ([RFC 6582](\ref rfc::rfc6582)): resend it now
+        if (_fast_recovery and not _segments_pending.empty() and not _segments_pending.front().retransmitted) {
+            OutstandingSegment &front = _segments_pending.front();
+            _account(front, -1);
+            front.lost = front.retransmitted = true;
+            _account(front, 1);
+            _retransmit(front);
         }
 
+        // repair any holes before sending new data
+        _retransmit_lost_segments();
+
         // now receiver (may) have more room to receive, fill the window
         fill_window();
     } else if (absolute_ackno == _receiver_window_left) {
+        // a duplicate ack ([RFC 5681](\ref rfc::rfc5681)) leaves data outstanding and the window as it was
+        const uint64_t receiver_window_size = zero_window_size and not _persist ? 1 : window_size;
+        const bool duplicate =
+            may_be_duplicate and _bytes_in_flight > 0 and receiver_window_size == _receiver_window_size;
+
         // processed this ackno before, just update window size
-        _receiver_window_size = zero_window_size ? 1 : window_size;
+        _receiver_window_size = receiver_window_size;
         _receiver_window_left = absolute_ackno;
         _receiver_window_right = absolute_ackno + _receiver_window_size;
+
+        if (duplicate) {
+            _duplicate_ack_received();
+        }
+
+        // a duplicate ack may carry news of more SACKed data
+        const auto sample = _take_rate_sample();
+        if (sample.has_value()) {
+            _congestion->on_ack(
+                {_time_ms, absolute_ackno, _next_seqno, 0, _bytes_in_flight, {}, _delivered, sample, _pipe()});
+        }
+        _retransmit_lost_segments();
+    }
+    _update_persist_timer();
+}
+
+//! \details Below DUP_THRESH, the segment the duplicate ack stands for makes room in the pipe for
+//! a new one (limited transmit, [RFC 3042](\ref rfc::rfc3042)). At DUP_THRESH, the oldest segment is
+//! deemed lost and resent, and fast recovery begins, unless the sender is already recovering.
+void TCPSender::_duplicate_ack_received() {
+    _dup_acks++;
+    if (_dup_acks != DUP_THRESH or _recovery_point.has_value()) {
+        return;
+    }
+
+    OutstandingSegment &front = _segments_pending.front();
+    _account(front, -1);
+    front.lost = true;
+    _account(front, 1);
+    _recovery_point = _next_seqno;
+    _fast_recovery = true;
+    _congestion->on_loss(_time_ms, _bytes_in_flight, _next_seqno, _pipe());
+
+    _account(front, -1);
+    front.retransmitted = true;
+    _account(front, 1);
+    _retransmit(front);
+}
+
+void TCPSender::_account(const OutstandingSegment &pending, const int sign) {
+    const uint64_t len = pending.segment.length_in_sequence_space();
+    if (pending.sacked) {
+        _sacked_bytes += sign * len;
+        _sacked_segments += sign;
+        return;
+    }
+    if (pending.lost) {
+        _lost_bytes += sign * len;
+    }
+    if (pending.retransmitted) {
+        _retransmitted_bytes += sign * len;
+    }
+}
+
+//! \details Blocks that don't lie within the outstanding data are ignored. A segment is
+//! only marked once it is wholly covered by one block.
+void TCPSender::_update_scoreboard(const TCPHeader &header) {
+    for (size_t i = 0; i < header.num_sack_blocks; i++) {
+        const uint64_t left = unwrap(header.sack_blocks[i].left, _isn, _receiver_window_left);
+        const uint64_t right = unwrap(header.sack_blocks[i].right, _isn, _receiver_window_left);
+        if (left >= right or left < _receiver_window_left or right > _next_seqno) {
+            continue;
+        }
+
+        for (auto &pending : _segments_pending) {
+            if (pending.seqno >= right) {
+                break;
+            }
+            if (pending.seqno >= left and pending.end() <= right and not pending.sacked) {
+                _account(pending, -1);
+                pending.sacked = true;
+                _account(pending, 1);
+                _on_delivered(pending);
+            }
+        }
+    }
+}
+
+//! \details Implements the loss detection (IsLost) of [RFC 6675](\ref rfc::rfc6675): every unSACKed
+//! segment below the highest lost one is lost.
+void TCPSender::_mark_lost_by_dup_thresh() {
+    // find the highest lost segment, counting the SACKed segments above each from the top down
+    size_t sacked_above = 0;
+    size_t sacked_bytes_above = 0;
+    auto lost_end = _segments_pending.rend();
+    for (auto it = _segments_pending.rbegin(); it != _segments_pending.rend(); ++it) {
+        if (it->sacked) {
+            sacked_above++;
+            sacked_bytes_above += it->segment.length_in_sequence_space();
+        } else if (sacked_above >= DUP_THRESH or sacked_bytes_above >= DUP_THRESH * _mss) {
+            lost_end = it;
+            break;
+        }
+    }
+
+    for (auto it = _segments_pending.begin(); it != lost_end.base(); ++it) {
+        if (not it->sacked and not it->lost) {
+            _account(*it, -1);
+            it->lost = true;
+            _account(*it, 1);
+        }
+    }
+}
+
+//! \details A segment is lost once the newest segment delivered was sent after it, and more than
+//! RACK's RTT plus the reordering window has passed since it was sent. That includes a retransmission,
+//! which is then due to be sent again.
+//!
+//! Segments sent once went out in sequence order, and a retransmission goes out after every first
+//! transmission before it; so past the first segment sent once after the newest delivered, none
+//! was sent before that one, and the scan stops there.
+uint64_t TCPSender::_mark_lost_by_rack() {
+    if (not _rack_sent_order.has_value()) {
+        return 0;
+    }
+    const uint64_t reordering_window = _rack_reordering_window();
+
+    uint64_t timeout = 0;
+    for (auto &pending : _segments_pending) {
+        if (pending.sent_order > _rack_sent_order.value()) {
+            if (pending.transmissions == 1) {
+                break;
+            }
+            continue;
+        }
+        if (pending.sacked or (pending.lost and not pending.retransmitted)) {
+            continue;
+        }
+        const uint64_t deadline = pending.sent_time + _rack_rtt + reordering_window;
+        if (deadline > _time_ms) {
+            timeout = max(timeout, deadline - _time_ms);
+            continue;
+        }
+        _account(pending, -1);
+        pending.lost = true;
+        pending.retransmitted = false;
+        _account(pending, 1);
+        _rack_losses++;
+    }
+    return timeout;
+}
+
+//! \details A quarter of the minimum RTT, but no more than the smoothed RTT. Until reordering is seen,
+//! there's no window during recovery, or once DUP_THRESH segments are SACKed.
+uint64_t TCPSender::_rack_reordering_window() const {
+    if (not _rack_reordering and (_recovery_point.has_value() or _sacked_segments >= DUP_THRESH)) {
+        return 0;
+    }
+    const auto quarter_min_rtt = static_cast<double>(_rtt.min_rtt().value_or(0)) / 4;
+    const auto window = static_cast<uint64_t>(min(quarter_min_rtt, _rtt.srtt().value_or(quarter_min_rtt)));
+    return max(window, RACK_MIN_REO_WND);
+}
+
+void TCPSender::_rack_on_delivered(const OutstandingSegment &pending) {
+    const uint64_t rtt = _time_ms - pending.sent_time;
+    // an ack this quick for a resent segment was likely for its first transmission
+    if (pending.transmissions > 1 and rtt < _rtt.min_rtt().value_or(0)) {
+        return;
+    }
+    if (pending.sent_order > _rack_sent_order.value_or(0)) {
+        _rack_sent_order = pending.sent_order;
+        _rack_rtt = rtt;
+    }
+
+    if (pending.end() > _rack_fack) {
+        _rack_fack = pending.end();
+    } else if (pending.transmissions == 1) {
+        _rack_reordering = true;
+    }
+}
+
+//! \details Lost segments are found by RACK once it's enabled, else by the RFC 6675 rule (which needs SACKed
+//! data). Retransmission follows the first rule of NextSeg() from [RFC 6675](\ref rfc::rfc6675): entering
+//! recovery retransmits the first hole at once; the rest go out as the congestion window allows.
+void TCPSender::_retransmit_lost_segments() {
+    uint64_t reordering_timeout = 0;
+    if (_rack_tlp) {
+        reordering_timeout = _mark_lost_by_rack();
+    } else if (_sacked_bytes > 0) {
+        _mark_lost_by_dup_thresh();
+    }
+    if (_lost_bytes == 0) {
+        if (reordering_timeout > 0) {
+            _timer.start(reordering_timeout, TimerEvent::ReorderTimeout);
+        }
+        return;
+    }
+
+    bool first_retransmission = false;
+    if (not _recovery_point.has_value()) {
+        _recovery_point = _next_seqno;
+        _congestion->on_loss(_time_ms, _bytes_in_flight, _next_seqno, _pipe());
+        first_retransmission = true;
+    }
+
+    for (auto &pending : _segments_pending) {
+        if (not pending.lost or pending.sacked or pending.retransmitted or pending.end() > _receiver_window_right) {
+            continue;
+        }
+        if (not first_retransmission and _pipe() + pending.segment.length_in_sequence_space() > _congestion->cwnd()) {
+            break;
+        }
+        _account(pending, -1);
+        pending.retransmitted = true;
+        _account(pending, 1);
+        _retransmit(pending);
+        first_retransmission = false;
+    }
+
+    if (reordering_timeout > 0) {
+        _timer.start(reordering_timeout, TimerEvent::ReorderTimeout);
+    } else if (not _timer.running()) {
+        _timer.start(_retransmission_timeout);
     }
 }
 
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
+    _time_ms += ms_since_last_tick;
     _timer.tick(ms_since_last_tick);
-    if (not _segments_pending.empty() and _timer.timeout()) {
-        // timeout, retrans first pending segment
-        _segments_out.push(_segments_pending.front());
-        ++_consecutive_retransmissions;
+    if (_pacer.has_value()) {
+        const bool held_back = _pacer->holding_back();
+        _pacer->refill(_time_ms, _pacing_rate());
+        if (held_back) {
+            fill_window();
+        }
+    }
+    if (not _segments_pending.empty() and _timer.timeout() and _timer.event() == TimerEvent::ReorderTimeout) {
+        // segments RACK was waiting on may be lost by now
+        _timer.stop();
+        _retransmit_lost_segments();
+        if (not _timer.running()) {
+            _restart_timer();
+        }
+    } else if (not _segments_pending.empty() and _timer.timeout() and _timer.event() == TimerEvent::LossProbe) {
+        _send_loss_probe();
+    } else if (not _segments_pending.empty() and _timer.timeout()) {
+        // timeout, retrans first pending segment, and start loss recovery over: any hole may need resending again
+        for (auto &pending : _segments_pending) {
+            _account(pending, -1);
+            pending.lost = pending.retransmitted = false;
+            _account(pending, 1);
+        }
+        OutstandingSegment &front = _segments_pending.front();
+        _account(front, -1);
+        front.lost = front.retransmitted = true;
+        _account(front, 1);
+        _recovery_point = _next_seqno;
+        _fast_recovery = false;
+        _dup_acks = 0;
+        _tlp_end.reset();
+        _retransmit(front);
         if (not zero_window_size) {
+            ++_consecutive_retransmissions;
+            _congestion->on_rto(_time_ms, _bytes_in_flight);
             _retransmission_timeout *= 2;
+        } else if (_persist) {
+            // the resend probes the zero window, as the persist timer would, and backs off the same way
+            ++_consecutive_retransmissions;
+            _retransmission_timeout = min(2 * _retransmission_timeout, _rtt.rto_max());
+        } else {
+            // a probe of a zero window isn't a sign of congestion
+            ++_consecutive_retransmissions;
         }
         _timer.start(_retransmission_timeout);
     }
     if (_segments_pending.empty()) {
         _timer.stop();
     }
+
+    _persist_timer.tick(ms_since_last_tick);
+    if (_persist_timer.timeout()) {
+        _send_window_probe();
+    }
+}
+
+void TCPSender::_update_persist_timer() {
+    const bool held_back = not _stream.buffer_empty() or (_stream.eof() and not _fined);
+    if (not _persist or _receiver_window_size > 0 or not _segments_pending.empty() or not held_back) {
+        _persist_timer.stop();
+        return;
+    }
+    if (not _persist_timer.running()) {
+        _persist_timeout = _retransmission_timeout;
+        _persist_timer.start(_persist_timeout);
+    }
+}
+
+//! \details The probe takes a copy of the byte, leaving it in the stream: a window that opens later sends it
+//! again in an ordinary segment.
+void TCPSender::_send_window_probe() {
+    TCPSegmentBuilder builder;
+    builder.with_seqno(next_seqno());
+    if (not _stream.buffer_empty()) {
+        builder.with_data(Buffer{_stream.peek_output(1)});
+    } else {
+        builder.with_fin();
+    }
+    _segments_out.push(builder.build_segment());
+    _probe_outstanding = true;
+    _window_probes++;
+    _consecutive_retransmissions++;
+
+    _persist_timeout = min(2 * _persist_timeout, _rtt.rto_max());
+    _persist_timer.start(_persist_timeout);
+}
+
+void TCPSender::_take_window_probe() {
+    if (not _stream.buffer_empty()) {
+        _stream.pop_output(1);
+    } else {
+        _fined = true;
+    }
+    _next_seqno++;
+    _probe_outstanding = false;
+}
+
+void TCPSender::_restart_timer() {
+    if (_segments_pending.empty()) {
+        _timer.stop();
+    } else if (_may_probe()) {
+        _timer.start(_probe_timeout(), TimerEvent::LossProbe);
+    } else {
+        _timer.start(_retransmission_timeout);
+    }
+}
+
+//! \details Not while recovering from loss, nor while an earlier probe is unacknowledged
+bool TCPSender::_may_probe() const {
+    return _rack_tlp and not _recovery_point.has_value() and not _tlp_end.has_value() and not zero_window_size;
+}
+
+//! \details Per [RFC 8985](\ref rfc::rfc8985) section 7.2, with 1 s standing in for 2 * SRTT until there's an
+//! RTT sample, and a floor of TLP_MIN_PTO
+uint64_t TCPSender::_probe_timeout() const {
+    uint64_t timeout = TCPConfig::TIMEOUT_DFLT;
+    if (_rtt.srtt().has_value()) {
+        timeout = static_cast<uint64_t>(ceil(2 * _rtt.srtt().value()));
+        if (_segments_pending.size() == 1) {
+            timeout += TLP_MAX_ACK_DELAY;
+        }
+    }
+    return min(max(timeout, TLP_MIN_PTO), _retransmission_timeout);
+}
+
+//! \details New data makes the receiver's acks show which segments (if any) are missing, so RACK can find
+//! them; failing that, resending the newest segment draws an ack that does. The probe is sent
+//! regardless of the congestion window, and the retransmission timer then takes over.
+void TCPSender::_send_loss_probe() {
+    const uint64_t receiver_remaining = _receiver_window_remaining();
+    if (not _stream.buffer_empty() and receiver_remaining > 0) {
+        Buffer payload = _stream.read_buffer(min(receiver_remaining, _max_payload()));
+        TCPSegmentBuilder builder;
+        builder.with_seqno(next_seqno()).with_data(move(payload));
+        _send(builder);
+        _tlp_retransmitted = false;
+    } else {
+        _retransmit(_segments_pending.back());
+        _tlp_retransmitted = true;
+    }
+    _tlp_end = _next_seqno;
+    _tlp_probes++;
+    _timer.start(_retransmission_timeout);
+}
+
+optional<double> TCPSender::_pacing_rate() const {
+    return _fixed_pacing_rate.has_value() ? _fixed_pacing_rate : _congestion->pacing_rate();
+}
+
+void TCPSender::enable_pacing(const optional<double> rate, const size_t burst) {
+    _fixed_pacing_rate = rate;
+    _pacer.emplace(burst);
+    _pacer->refill(_time_ms, _pacing_rate());
+}
+
+optional<uint64_t> TCPSender::time_until_release() const {
+    if (not _pacer.has_value()) {
+        return {};
+    }
+    return _pacer->time_until_release();
 }
 
 unsigned int TCPSender::consecutive_retransmissions() const { return _consecutive_retransmissions;; }
@@ -150,15 +700,82 @@ void TCPSender::send_empty_segment() {
 
 void TCPSender::_send(TCPSegmentBuilder &builder) {
     TCPSegment seg = builder.build_segment();
-    _segments_out.push(seg);
+    const auto seg_len = seg.length_in_sequence_space();
     // don't re-trans empty ACKs?
-    if (seg.length_in_sequence_space() > 0) {
-        _segments_pending.push_back(seg);
+    if (seg_len > 0) {
+        // the byte a window probe carried goes out for good now
+        _probe_outstanding = false;
+        _segments_pending.push_back({seg, _next_seqno, _time_ms, ++_transmissions});
+        _stamp_delivery_state(_segments_pending.back());
+        _bytes_in_flight += seg_len;
+        if (seg.payload().size() < _max_payload()) {
+            _short_segment_end = _next_seqno + seg_len;
+        }
+        if (_pacer.has_value()) {
+            _pacer->consume(seg_len);
+        }
         // Every time a segment containing data (nonzero length in sequence space) is sent
-        // (whether it’s the first time or a retransmission), if the timer is not running, start it
-        if (not _timer.running()) {
-            _timer.start(_retransmission_timeout);
+        // (whether it’s the first time or a retransmission), if the timer is not running, start it.
+        // A probe timer is pushed back: the tail has moved.
+        if (not _timer.running() or _timer.event() == TimerEvent::LossProbe) {
+            _restart_timer();
         }
     }
-    _next_seqno += seg.length_in_sequence_space();
-}
\ No newline at end of file
+    _segments_out.push(move(seg));
+    _next_seqno += seg_len;
+}
+
+void TCPSender::_retransmit(OutstandingSegment &pending) {
+    pending.transmissions++;
+    pending.sent_time = _time_ms;
+    pending.sent_order = ++_transmissions;
+    _stamp_delivery_state(pending);
+    _segments_out.push(pending.segment);
+}
+
+void TCPSender::_stamp_delivery_state(OutstandingSegment &pending) {
+    if (_bytes_in_flight == 0) {
+        // nothing was in flight, so no interval is under way: this segment begins one
+        _first_sent_time = _delivered_time = _time_ms;
+    }
+    pending.delivered = _delivered;
+    pending.delivered_time = _delivered_time;
+    pending.first_sent_time = _first_sent_time;
+    pending.app_limited = _app_limited != 0;
+}
+
+void TCPSender::_on_delivered(const OutstandingSegment &pending) {
+    if (_rack_tlp) {
+        _rack_on_delivered(pending);
+    }
+
+    _delivered += pending.segment.length_in_sequence_space();
+    _delivered_time = _time_ms;
+    if (_app_limited != 0 and _delivered > _app_limited) {
+        _app_limited = 0;  // everything sent while short of data has been delivered
+    }
+
+    if (not _rate_sample_start.has_value() or pending.delivered >= _rate_sample_start->prior_delivered) {
+        const uint64_t send_elapsed = pending.sent_time - pending.first_sent_time;
+        _rate_sample_start = {pending.delivered, pending.delivered_time, send_elapsed, pending.app_limited};
+        _first_sent_time = pending.sent_time;
+    }
+}
+
+//! \details The interval is the longer of the time taken to send the sampled data and the time
+//! taken to acknowledge it; intervals shorter than the minimum RTT are discarded, as ack
+//! compression makes them look faster than the path.
+optional<RateSample> TCPSender::_take_rate_sample() {
+    if (not _rate_sample_start.has_value()) {
+        return {};
+    }
+    const RateSampleStart start = _rate_sample_start.value();
+    _rate_sample_start.reset();
+
+    const uint64_t ack_elapsed = _delivered_time - start.prior_time;
+    const uint64_t interval = max(start.send_elapsed, ack_elapsed);
+    if (interval == 0 or interval < _rtt.min_rtt().value_or(0)) {
+        return {};
+    }
+    return RateSample{start.prior_delivered, _delivered - start.prior_delivered, interval, start.app_limited};
+}
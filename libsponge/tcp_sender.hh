@@ -2,13 +2,22 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "pacer.hh"
+#include "rtt_estimator.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
+#include <deque>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <queue>
-#include <list>
+
+//! \brief What the retransmission timer is armed for: besides the RTO, it serves as the RACK reordering
+//! timer and the Tail Loss Probe timer ([RFC 8985](\ref rfc::rfc8985))
+enum class TimerEvent { Retransmission, ReorderTimeout, LossProbe };
 
 //! \brief The "sender" part of a TCP implementation.
 class RetransmissionTimer {
@@ -16,15 +25,18 @@ class RetransmissionTimer {
     size_t _timeout{0};
     size_t _time_elapsed{0};
     bool _running{false};
+    TimerEvent _event{TimerEvent::Retransmission};
   public:
-    void start(size_t timeout) {
+    void start(size_t timeout, const TimerEvent event = TimerEvent::Retransmission) {
         reset(timeout);
         _running = true;
+        _event = event;
     }
     bool timeout() const {
         return _running and _time_elapsed >= _timeout;
     }
     bool running() const { return _running; }
+    TimerEvent event() const { return _event; }
     void tick(size_t ms_since_last_tick) {
         if (_running)
             _time_elapsed += ms_since_last_tick;
@@ -47,7 +59,7 @@ class TCPSegmentBuilder {
     bool fin{false};
     WrappingInt32 seqno{0};
     WrappingInt32 ackno{0};
-    std::string data{};
+    Buffer data{};
 
   public:
     TCPSegmentBuilder &with_ack(WrappingInt32 ackno_) {
@@ -80,14 +92,15 @@ class TCPSegmentBuilder {
 
     TCPSegmentBuilder &with_seqno(uint32_t seqno_) { return with_seqno(WrappingInt32{seqno_}); }
 
-    TCPSegmentBuilder &with_data(std::string data_) {
+    TCPSegmentBuilder &with_data(Buffer data_) {
         data = std::move(data_);
         return *this;
     }
 
+    //! \note the segment shares the builder's payload storage; nothing is copied
     TCPSegment build_segment() const {
         TCPSegment seg;
-        seg.payload() = std::string(data);
+        seg.payload() = data;
         seg.header().ack = ack;
         seg.header().fin = fin;
         seg.header().syn = syn;
@@ -98,6 +111,43 @@ class TCPSegmentBuilder {
     }
 };
 
+//! \brief A segment that has been sent but not yet cumulatively acknowledged, with its
+//! [SACK scoreboard](\ref rfc::rfc6675) state
+struct OutstandingSegment {
+    TCPSegment segment;         //!< the segment as first sent
+    uint64_t seqno;             //!< absolute sequence number of its first byte
+    uint64_t sent_time;         //!< when it was last (re)transmitted, on the sender's clock
+    uint64_t sent_order;        //!< which of the sender's transmissions that was, to order those in the same ms
+    unsigned transmissions{1};  //!< how many times it has been sent
+    bool sacked{false};         //!< covered by a SACK block from the receiver
+    bool lost{false};           //!< deemed lost by the scoreboard
+    bool retransmitted{false};  //!< retransmitted since loss recovery began
+
+    //! \name The sender's delivery state when the segment was last sent, for rate sampling
+    //!@{
+    uint64_t delivered{0};        //!< bytes delivered so far
+    uint64_t delivered_time{0};   //!< when that count last grew
+    uint64_t first_sent_time{0};  //!< send time of the segment that began the sampling interval
+    bool app_limited{false};      //!< the sender was short of data to send
+    //!@}
+
+    //! absolute sequence number just past the segment
+    uint64_t end() const { return seqno + segment.length_in_sequence_space(); }
+};
+
+//! \brief What a TCPSender has measured of its connection
+struct TCPSenderStats {
+    std::optional<double> srtt{};          //!< smoothed round-trip time, in ms, once there is a sample
+    double rttvar = 0;                     //!< round-trip time variation, in ms
+    std::optional<uint64_t> min_rtt{};     //!< smallest round-trip time sample, in ms
+    std::optional<uint64_t> latest_rtt{};  //!< most recent round-trip time sample, in ms
+    unsigned rtt_samples = 0;              //!< round-trip times sampled (none from retransmitted segments)
+    uint64_t rto = 0;                      //!< retransmission timeout, backoff included, in ms
+    unsigned tlp_probes = 0;               //!< tail loss probes sent
+    unsigned rack_losses = 0;              //!< segments RACK deemed lost
+    unsigned window_probes = 0;            //!< zero-window probes sent by the persist timer
+};
+
 //! Accepts a ByteStream, divides it up into segments and sends the
 //! segments, keeps track of which segments are still in-flight,
 //! maintains the Retransmission Timer, and retransmits in-flight
@@ -110,8 +160,8 @@ class TCPSender {
     //! outbound queue of segments that the TCPSender wants sent
     std::queue<TCPSegment> _segments_out{};
 
-    //! retransmission timer for the connection
-    unsigned int _initial_retransmission_timeout;
+    //! round-trip time estimate, from which the retransmission timeout is derived
+    RTTEstimator _rtt;
 
     //! outgoing stream of bytes that have not yet been sent
     ByteStream _stream;
@@ -119,13 +169,119 @@ class TCPSender {
     //! the (absolute) sequence number for the next byte to be sent
     uint64_t _next_seqno{0};
 
+    //! the largest payload and options to send in a segment
+    size_t _mss{TCPConfig::MAX_PAYLOAD_SIZE};
+
+    //! the room the options on each new segment take out of its payload ([RFC 6691](\ref rfc::rfc6691))
+    size_t _options_length{0};
+
     bool zero_window_size{false};
-    uint16_t _receiver_window_size{1};
+    uint64_t _receiver_window_size{1};
+    uint8_t _window_shift{0};  //!< The peer's window scale shift count ([RFC 7323](\ref rfc::rfc7323))
     uint64_t _receiver_window_left{0};  // == last ackno from remote receiver
     uint64_t _receiver_window_right{1}; // == last ackno + window_size of remote receiver
-    unsigned int _retransmission_timeout;
+    uint64_t _retransmission_timeout;  //!< The estimator's RTO, doubled for each timeout since the last new ack
+
+    //! Segments sent but not yet acknowledged, in sequence order: the SACK scoreboard
+    std::deque<OutstandingSegment> _segments_pending{};
+    uint64_t _bytes_in_flight{0};      //!< Sequence space covered by `_segments_pending`
+    uint64_t _sacked_bytes{0};         //!< ... of which SACKed
+    uint64_t _sacked_segments{0};      //!< ... in this many segments
+    uint64_t _lost_bytes{0};           //!< ... of which lost and not SACKed
+    uint64_t _retransmitted_bytes{0};  //!< ... of which retransmitted and not SACKed
+
+    //! While recovering from loss, the next_seqno when recovery began; each hole is retransmitted
+    //! at most once until everything below this point is acknowledged (or the timer expires)
+    std::optional<uint64_t> _recovery_point{};
+
+    //! An unSACKed segment is lost once this many segments (or full segments' worth of bytes)
+    //! above it have been SACKed ([RFC 6675](\ref rfc::rfc6675) DupThresh)
+    static constexpr size_t DUP_THRESH = 3;
+
+    //! \name Loss recovery without SACK, from duplicate acks ([RFC 5681](\ref rfc::rfc5681),
+    //! [RFC 6582](\ref rfc::rfc6582), [RFC 3042](\ref rfc::rfc3042))
+    //!@{
+
+    //! Duplicate acks since the ackno last advanced that carried no SACK blocks. Each is taken as a
+    //! segment that has left the network; the DUP_THRESH'th begins fast retransmit.
+    unsigned _dup_acks{0};
+
+    //! In the fast recovery that duplicate acks began: until it ends, each partial ack
+    //! retransmits the next hole
+    bool _fast_recovery{false};
+    //!@}
+
+    //! \name RACK-TLP loss detection ([RFC 8985](\ref rfc::rfc8985)), once enabled
+    //!@{
+
+    //! RACK's reordering window is at least this long, as the clock only counts whole milliseconds
+    static constexpr uint64_t RACK_MIN_REO_WND = 1;
+
+    //! A probe isn't sent sooner than this after the last transmission, in ms
+    static constexpr uint64_t TLP_MIN_PTO = 10;
+
+    //! Added to the probe timeout when a lone segment is outstanding: its ack may be delayed, in ms
+    static constexpr uint64_t TLP_MAX_ACK_DELAY = 200;
+
+    bool _rack_tlp{false};  //!< Detect losses by time and probe for lost tails (needs SACK)
+
+    std::optional<uint64_t> _rack_sent_order{};  //!< `sent_order` of the most recently sent segment delivered
+    uint64_t _rack_rtt{0};                       //!< RTT measured from that segment
+    uint64_t _rack_fack{0};                      //!< Highest end of any segment delivered
+    bool _rack_reordering{false};                //!< A segment never resent was delivered below `_rack_fack`
+    std::optional<uint64_t> _tlp_end{};          //!< next_seqno after the loss probe, until it's acknowledged
+    bool _tlp_retransmitted{false};              //!< That probe resent a segment (rather than sending new data)
+    unsigned _tlp_probes{0};                     //!< Loss probes sent
+    unsigned _rack_losses{0};                    //!< Segments RACK deemed lost
+    //!@}
+
+    //! The congestion control algorithm, which limits how much may be in flight
+    std::unique_ptr<CongestionController> _congestion;
+
+    //! Time acknowledgments by the timestamps they echo ([RFC 7323](\ref rfc::rfc7323)) rather than by the
+    //! segments they acknowledge, so resent segments are timed too
+    bool _timestamps{false};
+
+    //! \name Holding back short segments until more data comes
+    //!@{
+    TCPConfig::Nagle _nagle{TCPConfig::Nagle::Off};  //!< Nagle's algorithm, if on, and which variant
+    bool _corked{false};                             //!< Hold every short segment until uncorked
+    uint64_t _short_segment_end{0};                  //!< End of the last segment sent short of the largest payload
+    //!@}
+
+    //! \name The persist timer, once enabled: probes of a zero window ([RFC 9293](\ref rfc::rfc9293), section 3.8.6.1)
+    //!@{
+    bool _persist{false};                  //!< Probe a zero window on the persist timer, rather than treating it as 1
+    RetransmissionTimer _persist_timer{};  //!< Runs while a zero window holds back data and nothing is in flight
+    uint64_t _persist_timeout{0};          //!< The timer's current timeout, doubled after each probe
+    bool _probe_outstanding{false};        //!< A probe went out with the next byte (or the FIN) since the last send
+    unsigned _window_probes{0};            //!< Probes sent
+    //!@}
+
+    std::optional<Pacer> _pacer{};               //!< Spaces out new data, once pacing is enabled
+    std::optional<double> _fixed_pacing_rate{};  //!< Configured pacing rate, in bytes per ms, if any
+
+    uint64_t _time_ms{0};        //!< Milliseconds since construction, from tick()
+    uint64_t _transmissions{0};  //!< Segments sent so far, retransmissions included
+
+    //! \name Delivery rate estimation, per the IETF draft on
+    //! [delivery rate estimation](https://tools.ietf.org/html/draft-cheng-iccrg-delivery-rate-estimation)
+    //!@{
+    uint64_t _delivered{0};              //!< Bytes acknowledged or SACKed so far
+    uint64_t _delivered_time{0};         //!< When `_delivered` last grew
+    uint64_t _first_sent_time{0};        //!< Send time of the newest segment whose delivery was sampled
+    uint64_t _app_limited{0};            //!< If nonzero, samples are app-limited until `_delivered` passes it
+
+    //! Where the rate sample an acknowledgment is taking begins: at the most recently sent segment it delivered
+    struct RateSampleStart {
+        uint64_t prior_delivered;  //!< that segment's `delivered`
+        uint64_t prior_time;       //!< that segment's `delivered_time`
+        uint64_t send_elapsed;     //!< how long its sampling interval took to send
+        bool app_limited;          //!< that segment's `app_limited`
+    };
+    std::optional<RateSampleStart> _rate_sample_start{};
+    //!@}
 
-    std::list<TCPSegment> _segments_pending{};
     bool _syned{false};
     bool _fined{false};
 
@@ -134,11 +290,104 @@ class TCPSender {
 
     // only use this method when sending a segment at its first time
     void _send(TCPSegmentBuilder& builder);
+
+    //! Add (or, with `sign` -1, remove) a pending segment's share of the scoreboard's byte counts
+    void _account(const OutstandingSegment &pending, const int sign);
+
+    //! \brief Estimate of the bytes in the network ([RFC 6675](\ref rfc::rfc6675) pipe)
+    //! \details Outstanding bytes that are neither SACKed nor lost, less a segment for each
+    //! duplicate ack, plus those retransmitted
+    uint64_t _pipe() const;
+
+    //! \brief Process an acknowledgment
+    //! \param may_be_duplicate is whether the segment it came on carried no data, SYN, FIN or SACK blocks
+    //! \param window_size is the receiver's window, in bytes (already scaled)
+    //! \param echo_rtt is the round-trip time the ack's echoed timestamp gives, if it gives one
+    void _ack_received(const WrappingInt32 ackno,
+                       const uint64_t window_size,
+                       const bool may_be_duplicate,
+                       const std::optional<uint64_t> echo_rtt = {});
+
+    //! Count a duplicate ack, and begin fast retransmit on the DUP_THRESH'th
+    void _duplicate_ack_received();
+
+    //! Mark lost every unSACKed segment below the highest one with DUP_THRESH SACKed segments above it
+    void _mark_lost_by_dup_thresh();
+
+    //! \brief Mark lost the segments sent long enough before the newest delivered one (RACK)
+    //! \returns how long until the next segment would be lost by that rule, or 0 if none would
+    uint64_t _mark_lost_by_rack();
+
+    //! RACK's allowance for reordering, in ms
+    uint64_t _rack_reordering_window() const;
+
+    //! Update RACK's state for a segment newly acknowledged or SACKed
+    void _rack_on_delivered(const OutstandingSegment &pending);
+
+    //! Start the timer as the probe timer if a tail loss probe may be sent, else as the retransmission timer;
+    //! stop it if nothing is outstanding
+    void _restart_timer();
+
+    //! \returns whether a tail loss probe may be scheduled now
+    bool _may_probe() const;
+
+    //! The probe timeout: twice the smoothed RTT, with allowances, but no more than the RTO
+    uint64_t _probe_timeout() const;
+
+    //! Send a tail loss probe: a new segment if one fits in the receiver's window, else the newest outstanding again
+    void _send_loss_probe();
+
+    //! \returns the largest payload for a new segment: the MSS, less the room its options take
+    size_t _max_payload() const;
+
+    //! \returns whether a segment short of the largest payload for want of data should wait for more
+    bool _holds_short_segment() const;
+
+    //! Start the persist timer if a zero window holds back data with nothing in flight to bring an update;
+    //! stop it otherwise
+    void _update_persist_timer();
+
+    //! Probe the zero window with the next byte, or the FIN, without sending it for good, and back off the timer
+    void _send_window_probe();
+
+    //! The receiver took the probe's byte (or FIN): count it as sent
+    void _take_window_probe();
+
+    //! \returns the rate to pace at, in bytes per ms: the configured one, else the congestion controller's
+    std::optional<double> _pacing_rate() const;
+
+    //! How many more bytes the receiver's window allows to be sent
+    uint64_t _receiver_window_remaining() const;
+
+    //! How many more bytes the receiver's window and the congestion window allow to be sent
+    uint64_t _send_window_remaining() const;
+
+    //! Mark the pending segments covered by `header`'s SACK blocks
+    void _update_scoreboard(const TCPHeader &header);
+
+    //! Retransmit the holes the scoreboard deems lost that haven't been retransmitted yet
+    void _retransmit_lost_segments();
+
+    //! Send a pending segment again, with the delivery state as it stands now for rate sampling
+    void _retransmit(OutstandingSegment &pending);
+
+    //! Record the delivery state a segment is (re)sent with
+    void _stamp_delivery_state(OutstandingSegment &pending);
+
+    //! Count a pending segment as delivered (acknowledged or SACKed), and sample from it if it's the newest sent
+    void _on_delivered(const OutstandingSegment &pending);
+
+    //! \returns the rate sample taken by the acknowledgment just processed, if the interval was long enough
+    std::optional<RateSample> _take_rate_sample();
+
   public:
     //! Initialize a TCPSender
     TCPSender(const size_t capacity = TCPConfig::DEFAULT_CAPACITY,
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
-              const std::optional<WrappingInt32> fixed_isn = {});
+              const std::optional<WrappingInt32> fixed_isn = {},
+              std::unique_ptr<CongestionController> congestion_controller = {},
+              const std::optional<uint16_t> rto_min = {},
+              const uint16_t rto_max = TCPConfig::RTO_MAX_DFLT);
 
     //! \name "Input" interface for the writer
     //!@{
@@ -152,6 +401,13 @@ class TCPSender {
     //! \brief A new acknowledgment was received
     void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
 
+    //! \brief A new acknowledgment was received on `segment`, along with any [SACK](\ref rfc::rfc2018)
+    //! blocks in its header; its window is scaled as agreed, unless it's a SYN
+    //! \details Holes below data the receiver has SACKed are retransmitted right away,
+    //! rather than waiting for the retransmission timer. Without SACK, the third duplicate
+    //! ack (one on a segment carrying nothing else) retransmits the oldest segment.
+    void ack_received(const TCPSegment &segment);
+
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
 
@@ -173,6 +429,73 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief The congestion control algorithm in use
+    const CongestionController &congestion_controller() const { return *_congestion; }
+
+    //! \brief The round-trip time estimate, the retransmission timeout, and loss recovery counts
+    TCPSenderStats stats() const;
+
+    //! \brief Detect losses by time ([RACK](\ref rfc::rfc8985)) instead of by DUP_THRESH, and probe for
+    //! lost tails (TLP) before the retransmission timer expires
+    //! \note Both rely on the receiver's SACK blocks: enable them only once SACK is negotiated.
+    void enable_rack_tlp() { _rack_tlp = true; }
+
+    //! \brief Probe a zero window from a persist timer, backing off exponentially, instead of treating it as a
+    //! window of 1 and resending that byte on the retransmission timer
+    //! \details A probe carries the next byte (or the FIN), but isn't outstanding: it's never retransmitted. If
+    //! the receiver takes it, the byte counts as sent. Data already in flight when the window shuts is resent on
+    //! the retransmission timer, which backs off the same way. Probes and resends alike count towards
+    //! consecutive_retransmissions() until an ack answers them, so a peer that vanishes behind a zero window is
+    //! given up on; one that keeps answering is probed for as long as its window stays shut.
+    void enable_persist_timer() { _persist = true; }
+
+    //! \brief Take RTT samples from the timestamps acks echo, once the timestamps option is agreed
+    //! \details Every ack that acknowledges new data is timed, even one for a resent segment: the echo
+    //! tells which transmission drew it, which Karn's algorithm otherwise can't.
+    void enable_timestamps() { _timestamps = true; }
+
+    //! \brief The sender's clock, in ms, as a TSval for the segments sent now
+    uint32_t timestamp() const { return static_cast<uint32_t>(_time_ms); }
+
+    //! \brief Scale the windows the peer advertises up by `shift` bits ([RFC 7323](\ref rfc::rfc7323))
+    //! \note Only for acks that come on segments: ack_received(ackno, window_size) takes the window as is.
+    void enable_window_scaling(const uint8_t shift) { _window_shift = shift; }
+
+    //! \brief Send segments of at most `mss` bytes of payload and options, and count the congestion controller's
+    //! segments in them
+    //! \note Set before data is sent: segments already sent keep their size.
+    void set_mss(const size_t mss);
+
+    //! \brief The largest payload sent in a segment, before the room options take out of it
+    size_t mss() const { return _mss; }
+
+    //! \brief Leave room for `length` bytes of options in each new segment ([RFC 6691](\ref rfc::rfc6691))
+    //! \note Segments already sent keep their size when resent.
+    void set_options_length(const size_t length) { _options_length = length; }
+
+    //! \brief Hold back segments short of the MSS by Nagle's algorithm, or its Minshall variant
+    void set_nagle(const TCPConfig::Nagle nagle) { _nagle = nagle; }
+
+    //! \brief Send only full segments until uncork() (like Linux's TCP_CORK), whatever Nagle's algorithm allows
+    //! \note The FIN still flushes the last short segment. Unlike Linux, there's no 200 ms limit on the wait.
+    void cork() { _corked = true; }
+
+    //! \brief Stop holding back short segments for cork(); the caller then calls fill_window() to send them
+    void uncork() { _corked = false; }
+
+    //! \brief Has cork() been called without a later uncork()?
+    bool corked() const { return _corked; }
+
+    //! \brief Release new data no faster than a pacing rate, through a token bucket
+    //! \param rate is the rate in bytes per ms; if empty, the congestion controller's, if it gives one
+    //! \param burst is how much may be sent back to back, in bytes
+    //! \note Retransmissions aren't paced: they repair what was already sent at the paced rate.
+    void enable_pacing(const std::optional<double> rate, const size_t burst);
+
+    //! \brief How long until the pacer releases data it's holding back, in ms, if it is
+    //! \details tick() then sends it. Until that time the owner needn't call tick() for the pacer's sake.
+    std::optional<uint64_t> time_until_release() const;
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
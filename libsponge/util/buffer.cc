@@ -1,14 +1,108 @@
 #include "buffer.hh"
 
+#include <new>
+
 using namespace std;
 
+static_assert(sizeof(BufferStorage) <= BufferStorage::OVERHEAD, "BufferStorage outgrew its reserved space");
+
+BufferStorage::BufferStorage(string &&str, const BufferPool::SizeClass size_class)
+    : _adopted(move(str)), _data(_adopted.data()), _capacity(_adopted.size()), _size_class(size_class) {}
+
+BufferStorage::BufferStorage(char *data,
+                             const size_t capacity,
+                             const size_t headroom,
+                             const BufferPool::SizeClass size_class)
+    : _data(data), _capacity(capacity), _headroom(headroom), _size_class(size_class) {}
+
+//! \param[in] str is the string to adopt; its bytes stay where they are
+BufferStorage *BufferStorage::adopt(string &&str) {
+    BufferPool::SizeClass size_class{};
+    void *block = BufferPool::allocate(sizeof(BufferStorage), size_class);
+    return new (block) BufferStorage(move(str), size_class);
+}
+
+//! \param[in] capacity is the number of bytes of storage needed
+//! \param[in] headroom is the number of those bytes, at the front, to leave unclaimed
+BufferStorage *BufferStorage::allocate(const size_t capacity, const size_t headroom) {
+    BufferPool::SizeClass size_class{};
+    char *block = static_cast<char *>(BufferPool::allocate(OVERHEAD + capacity, size_class));
+    return new (block) BufferStorage(block + OVERHEAD, capacity, headroom, size_class);
+}
+
+void BufferStorage::destroy() {
+    const auto size_class = _size_class;
+    this->~BufferStorage();
+    BufferPool::deallocate(this, size_class);
+}
+
+Buffer::Buffer(string &&str) {
+    if (str.empty()) {
+        return;
+    }
+    _storage = BufferStorage::adopt(move(str));
+    _ending_offset = _storage->capacity();
+}
+
+//! \param[in] len is the size of the new Buffer
+//! \param[in] headroom is the number of bytes to reserve in front of it
+Buffer Buffer::allocate(const size_t len, const size_t headroom) {
+    Buffer ret;
+    if (len + headroom > 0) {
+        ret._storage = BufferStorage::allocate(headroom + len, headroom);
+        ret._starting_offset = headroom;
+        ret._ending_offset = headroom + len;
+    }
+    return ret;
+}
+
+char *Buffer::mutable_data() {
+    if (not _storage) {
+        return nullptr;
+    }
+    if (_storage->shared()) {
+        throw runtime_error("Buffer::mutable_data: storage is shared with another Buffer");
+    }
+    return _storage->data() + _starting_offset;
+}
+
+//! \param[in] n is the number of bytes to add at the front
+char *Buffer::prepend(const size_t n) {
+    if (not can_prepend(n)) {
+        throw runtime_error("Buffer::prepend: not enough headroom");
+    }
+    _storage->claim_headroom(n);
+    _starting_offset -= n;
+    return _storage->data() + _starting_offset;
+}
+
 void Buffer::remove_prefix(const size_t n) {
     if (n > str().size()) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
-        _storage.reset();
+    if (_storage and _starting_offset == _ending_offset) {
+        *this = Buffer{};
+    }
+}
+
+Buffer Buffer::slice(const size_t offset, const size_t len) const {
+    if (offset > size() or len > size() - offset) {
+        throw out_of_range("Buffer::slice");
+    }
+    Buffer ret{*this};
+    ret.remove_prefix(offset);
+    ret.remove_suffix(ret.size() - len);
+    return ret;
+}
+
+void Buffer::remove_suffix(const size_t n) {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _ending_offset -= n;
+    if (_storage and _starting_offset == _ending_offset) {
+        *this = Buffer{};
     }
 }
 
@@ -16,6 +110,27 @@ void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
     }
+    _size += other._size;
+}
+
+void BufferList::append(Buffer buffer) {
+    if (buffer.size() > 0) {
+        _size += buffer.size();
+        _buffers.push_back(std::move(buffer));
+    }
+}
+
+//! \param[in] n is the number of bytes to add at the front
+char *BufferList::prepend(const size_t n) {
+    _size += n;
+    if (not _buffers.empty() and _buffers.front().can_prepend(n)) {
+        return _buffers.front().prepend(n);
+    }
+
+    Buffer front = Buffer::allocate(n);
+    char *ret = front.mutable_data();
+    _buffers.push_front(std::move(front));
+    return ret;
 }
 
 BufferList::operator Buffer() const {
@@ -40,20 +155,13 @@ string BufferList::concatenate() const {
     return ret;
 }
 
-size_t BufferList::size() const {
-    size_t ret = 0;
-    for (const auto &buf : _buffers) {
-        ret += buf.size();
+void BufferList::remove_prefix(size_t n) {
+    if (n > _size) {
+        throw std::out_of_range("BufferList::remove_prefix");
     }
-    return ret;
-}
+    _size -= n;
 
-void BufferList::remove_prefix(size_t n) {
     while (n > 0) {
-        if (_buffers.empty()) {
-            throw std::out_of_range("BufferList::remove_prefix");
-        }
-
         if (n < _buffers.front().str().size()) {
             _buffers.front().remove_prefix(n);
             n = 0;
@@ -64,18 +172,19 @@ void BufferList::remove_prefix(size_t n) {
     }
 }
 
-BufferViewList::BufferViewList(const BufferList &buffers) {
+BufferViewList::BufferViewList(const BufferList &buffers) : _size(buffers.size()) {
     for (const auto &x : buffers.buffers()) {
         _views.push_back(x);
     }
 }
 
 void BufferViewList::remove_prefix(size_t n) {
-    while (n > 0) {
-        if (_views.empty()) {
-            throw std::out_of_range("BufferListView::remove_prefix");
-        }
+    if (n > _size) {
+        throw std::out_of_range("BufferListView::remove_prefix");
+    }
+    _size -= n;
 
+    while (n > 0) {
         if (n < _views.front().size()) {
             _views.front().remove_prefix(n);
             n = 0;
@@ -86,17 +195,8 @@ void BufferViewList::remove_prefix(size_t n) {
     }
 }
 
-size_t BufferViewList::size() const {
-    size_t ret = 0;
-    for (const auto &buf : _views) {
-        ret += buf.size();
-    }
-    return ret;
-}
-
-vector<iovec> BufferViewList::as_iovecs() const {
-    vector<iovec> ret;
-    ret.reserve(_views.size());
+SmallVector<iovec, 4> BufferViewList::as_iovecs() const {
+    SmallVector<iovec, 4> ret;
     for (const auto &x : _views) {
         ret.push_back({const_cast<char *>(x.data()), x.size()});
     }
@@ -1,28 +1,173 @@
 #ifndef SPONGE_LIBSPONGE_BUFFER_HH
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
+#include "buffer_pool.hh"
+#include "small_vector.hh"
+
 #include <algorithm>
-#include <deque>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <sys/uio.h>
+#include <utility>
 #include <vector>
 #include <cassert>
 
-//! \brief A reference-counted read-only string that can discard bytes from the front
+//! \brief The storage shared by a Buffer and its copies
+//! \details Lives in a block from BufferPool: this object first, then (for storage made by
+//! allocate()) the bytes themselves. The reference count is deliberately not atomic, so a
+//! Buffer and all of its copies must be used by one thread at a time. They may be handed over
+//! whole, as a TCPSpongeSocket's connection is to its TCP thread after the handshake; the pool
+//! takes back a block on whichever thread frees it.
+class BufferStorage {
+  private:
+    std::string _adopted{};             //!< The string taken over by adopt(), if any
+    char *_data;                        //!< The first byte of storage
+    size_t _capacity;                   //!< The number of bytes of storage
+    size_t _headroom{0};                //!< The number of bytes at the front not yet claimed by any Buffer
+    uint32_t _refcount{1};              //!< The number of Buffers referring to this storage
+    BufferPool::SizeClass _size_class;  //!< The pool size class of the block holding this object
+
+    BufferStorage(std::string &&str, const BufferPool::SizeClass size_class);
+    BufferStorage(char *data, const size_t capacity, const size_t headroom, const BufferPool::SizeClass size_class);
+
+    //! Destroy this object and return its block to the pool
+    void destroy();
+
+  public:
+    //! Space reserved at the front of a pool block for the BufferStorage object itself
+    static constexpr size_t OVERHEAD = 64;
+
+    //! The largest storage that allocate() can still serve from the pool's MTU size class
+    static constexpr size_t MAX_POOLED_CAPACITY = BufferPool::MTU_BLOCK_SIZE - OVERHEAD;
+
+    //! \brief Take ownership of a string without copying it
+    static BufferStorage *adopt(std::string &&str);
+
+    //! \brief Allocate `capacity` bytes of uninitialized storage, the first `headroom` of them unclaimed
+    static BufferStorage *allocate(const size_t capacity, const size_t headroom = 0);
+
+    //! \name Reference counting
+    //!@{
+    void retain() { ++_refcount; }
+    void release() {
+        if (--_refcount == 0) {
+            destroy();
+        }
+    }
+    bool shared() const { return _refcount > 1; }
+    //!@}
+
+    char *data() const { return _data; }
+    size_t capacity() const { return _capacity; }
+
+    //! \name Headroom
+    //! The unclaimed bytes at the front of the storage. Each claim takes the bytes just
+    //! before the ones already claimed, so no two Buffers can ever write the same headroom.
+    //!@{
+    size_t headroom() const { return _headroom; }
+    void claim_headroom(const size_t n) { _headroom -= n; }
+    //!@}
+
+    //! \name
+    //! A BufferStorage cannot be copied or moved
+    //!@{
+    BufferStorage(const BufferStorage &other) = delete;
+    BufferStorage &operator=(const BufferStorage &other) = delete;
+    BufferStorage(BufferStorage &&other) = delete;
+    BufferStorage &operator=(BufferStorage &&other) = delete;
+    //!@}
+
+    ~BufferStorage() = default;
+};
+
+//! \brief A reference-counted read-only string that can discard bytes from the front or back
 class Buffer {
   private:
-    std::shared_ptr<std::string> _storage{};
+    BufferStorage *_storage{nullptr};
     size_t _starting_offset{};
+    size_t _ending_offset{};  //!< One past the last visible byte of `_storage`
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    //! \throws unix_error if the pool can't map a slab for the storage
+    Buffer(std::string &&str);
+
+    //! \brief Allocate a Buffer of `len` uninitialized bytes, to be filled in through mutable_data()
+    //! \details If `headroom` is nonzero, that many bytes are reserved in front of the Buffer,
+    //! so that headers can later be prepend()ed to it in place.
+    //! \note Buffers of up to BufferStorage::MAX_POOLED_CAPACITY bytes (with headroom) come from BufferPool.
+    static Buffer allocate(const size_t len, const size_t headroom = 0);
+
+    //! \name Copy/move constructor/assignment operators
+    //! Copies share storage with the original
+    //!@{
+    Buffer(const Buffer &other) noexcept
+        : _storage(other._storage), _starting_offset(other._starting_offset), _ending_offset(other._ending_offset) {
+        if (_storage) {
+            _storage->retain();
+        }
+    }
+
+    Buffer &operator=(const Buffer &other) noexcept {
+        if (other._storage) {
+            other._storage->retain();
+        }
+        if (_storage) {
+            _storage->release();
+        }
+        _storage = other._storage;
+        _starting_offset = other._starting_offset;
+        _ending_offset = other._ending_offset;
+        return *this;
+    }
+
+    Buffer(Buffer &&other) noexcept
+        : _storage(other._storage), _starting_offset(other._starting_offset), _ending_offset(other._ending_offset) {
+        other._storage = nullptr;
+    }
+
+    Buffer &operator=(Buffer &&other) noexcept {
+        if (this != &other) {
+            if (_storage) {
+                _storage->release();
+            }
+            _storage = other._storage;
+            _starting_offset = other._starting_offset;
+            _ending_offset = other._ending_offset;
+            other._storage = nullptr;
+        }
+        return *this;
+    }
+    //!@}
+
+    ~Buffer() {
+        if (_storage) {
+            _storage->release();
+        }
+    }
+
+    //! \brief Writable access to the contents, e.g. to fill in a Buffer made by allocate()
+    //! \note Throws unless this Buffer is the only one referring to its storage
+    char *mutable_data();
+
+    //! \returns `true` if another Buffer refers to this one's storage too
+    bool shared() const { return _storage and _storage->shared(); }
+
+    //! \returns `true` if prepend(n) can grow this Buffer in place
+    bool can_prepend(const size_t n) const {
+        return _storage and _starting_offset == _storage->headroom() and n <= _starting_offset;
+    }
+
+    //! \brief Grow the Buffer by `n` bytes at the front, taking them from its storage's headroom
+    //! \returns a pointer to the new bytes, for the caller to fill in
+    //! \note Other Buffers sharing the storage are unaffected: the bytes were not part of any of them.
+    //! Throws unless can_prepend(n).
+    char *prepend(const size_t n);
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -30,7 +175,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->data() + _starting_offset, _ending_offset - _starting_offset};
     }
 
     // note: caller should make sure len is legal
@@ -38,7 +183,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        assert(size() <= len);
+        assert(len <= size());
         return {_storage->data() + _starting_offset, len};
     }
 
@@ -58,6 +203,14 @@ class Buffer {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief A Buffer sharing this one's storage, exposing `len` bytes starting at `offset`
+    //! \note No bytes are copied; the storage lives on until every slice is destroyed.
+    Buffer slice(const size_t offset, const size_t len) const;
+
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
+    void remove_suffix(const size_t n);
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -67,7 +220,8 @@ class Buffer {
 //! the TCPSegment in an IPv4Datagram) without copying the payload.
 class BufferList {
   private:
-    std::deque<Buffer> _buffers{};
+    SmallVector<Buffer, 4> _buffers{};  //!< Enough inline slots for a payload and its headers
+    size_t _size{0};                     //!< Total size of `_buffers`, in bytes
 
   public:
     //! \name Constructors
@@ -76,21 +230,49 @@ class BufferList {
     BufferList() = default;
 
     //! \brief Construct from a Buffer
-    BufferList(Buffer buffer) : _buffers{buffer} {}
+    BufferList(Buffer buffer) : _size(buffer.size()) { _buffers.push_back(std::move(buffer)); }
 
     //! \brief Construct by taking ownership of a std::string
-    BufferList(std::string &&str) noexcept {
+    BufferList(std::string &&str) {
         Buffer buf{std::move(str)};
         append(buf);
     }
     //!@}
 
+    //! \name Copy/move constructor/assignment operators
+    //! Copies share each Buffer's storage with the original; a moved-from BufferList is empty
+    //!@{
+    BufferList(const BufferList &other) = default;
+    BufferList &operator=(const BufferList &other) = default;
+    BufferList(BufferList &&other) noexcept
+        : _buffers(std::move(other._buffers)), _size(std::exchange(other._size, 0)) {}
+    BufferList &operator=(BufferList &&other) noexcept {
+        _buffers = std::move(other._buffers);
+        _size = std::exchange(other._size, 0);
+        return *this;
+    }
+    //!@}
+
+    ~BufferList() = default;
+
     //! \brief Access the underlying queue of Buffers
-    const std::deque<Buffer> &buffers() const { return _buffers; }
+    const SmallVector<Buffer, 4> &buffers() const { return _buffers; }
 
     //! \brief Append a BufferList
     void append(const BufferList &other);
 
+    //! \brief Append a single Buffer
+    void append(Buffer buffer);
+
+    //! \brief Append a std::string, taking ownership of it
+    void append(std::string &&str) { append(Buffer{std::move(str)}); }
+
+    //! \brief Grow the list by `n` bytes at the front (e.g. to serialize a header in front of a payload)
+    //! \details The bytes come from the first Buffer's headroom if it has enough (see Buffer::prepend),
+    //! keeping a contiguous list contiguous; otherwise a new Buffer is put in front.
+    //! \returns a pointer to the new bytes, for the caller to fill in
+    char *prepend(const size_t n);
+
     //! \brief Transform to a Buffer
     //! \note Throws an exception unless BufferList is contiguous
     operator Buffer() const;
@@ -99,7 +281,7 @@ class BufferList {
     void remove_prefix(size_t n);
 
     //! \brief Size of the string
-    size_t size() const;
+    size_t size() const { return _size; }
 
     //! \brief Make a copy to a new std::string
     std::string concatenate() const;
@@ -107,12 +289,15 @@ class BufferList {
 
 //! \brief A non-owning temporary view (similar to std::string_view) of a discontiguous string
 class BufferViewList {
-    std::deque<std::string_view> _views{};
+    SmallVector<std::string_view, 4> _views{};
+    size_t _size{0};  //!< Total size of `_views`, in bytes
 
   public:
     //! \name Constructors
     //!@{
 
+    BufferViewList() = default;
+
     //! \brief Construct from a std::string
     BufferViewList(const std::string &str) : BufferViewList(std::string_view(str)) {}
 
@@ -123,19 +308,43 @@ class BufferViewList {
     BufferViewList(const BufferList &buffers);
 
     //! \brief Construct from a std::string_view
-    BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
+    BufferViewList(std::string_view str) : _size(str.size()) { _views.push_back(str); }
     //!@}
 
+    //! \name Copy/move constructor/assignment operators
+    //! A moved-from BufferViewList is empty
+    //!@{
+    BufferViewList(const BufferViewList &other) = default;
+    BufferViewList &operator=(const BufferViewList &other) = default;
+    BufferViewList(BufferViewList &&other) noexcept
+        : _views(std::move(other._views)), _size(std::exchange(other._size, 0)) {}
+    BufferViewList &operator=(BufferViewList &&other) noexcept {
+        _views = std::move(other._views);
+        _size = std::exchange(other._size, 0);
+        return *this;
+    }
+    //!@}
+
+    ~BufferViewList() = default;
+
+    //! \brief Append a view to the end of the list (empty views are skipped)
+    void append(std::string_view str) {
+        if (not str.empty()) {
+            _views.push_back(str);
+            _size += str.size();
+        }
+    }
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
     //! \brief Size of the string
-    size_t size() const;
+    size_t size() const { return _size; }
 
-    //! \brief Convert to a vector of `iovec` structures
+    //! \brief Convert to a contiguous array of `iovec` structures
     //! \note used for system calls that write discontiguous buffers,
     //! e.g. [writev(2)](\ref man2::writev) and [sendmsg(2)](\ref man2::sendmsg)
-    std::vector<iovec> as_iovecs() const;
+    SmallVector<iovec, 4> as_iovecs() const;
 };
 
 #endif  // SPONGE_LIBSPONGE_BUFFER_HH
@@ -0,0 +1,215 @@
+#include "buffer_pool.hh"
+
+#include "util.hh"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace {
+
+//! A free block, linked into its size class's free list
+//! \details The first block of a batch (see below) also links the batch to the next one and counts its blocks.
+struct FreeBlock {
+    FreeBlock *next;        //!< the next block in the batch
+    FreeBlock *next_batch;  //!< the next batch in the depot, in a batch's first block
+    size_t count;           //!< the number of blocks in the batch, in a batch's first block
+};
+
+//! The unused end of a slab, given back to the depot by a thread that exited; the header sits at its start
+struct SlabRest {
+    char *end;       //!< end of the slab
+    SlabRest *next;  //!< the next one in the depot
+};
+
+constexpr size_t NUM_POOLED_CLASSES = 2;
+
+constexpr array<size_t, NUM_POOLED_CLASSES> BLOCK_SIZES{BufferPool::HEADER_BLOCK_SIZE, BufferPool::MTU_BLOCK_SIZE};
+
+//! The number of free blocks a thread collects before moving them aside as a batch
+constexpr size_t BATCH_SIZE = 64;
+
+//! Free blocks and slab ends that no thread holds, shared by all threads under a lock
+struct Depot {
+    mutex lock{};
+    array<FreeBlock *, NUM_POOLED_CLASSES> batches{};  //!< batches of free blocks, linked through `next_batch`
+    array<SlabRest *, NUM_POOLED_CLASSES> slab_rests{};  //!< unused ends of slabs
+};
+
+Depot depot{};
+
+//! \brief Per-thread pool state
+//! \details Each class keeps up to two batches: `loaded`, which allocation and freeing work on, and `spare`,
+//! a full batch set aside. A thread that frees more than it allocates (one that releases Buffers made on
+//! another thread, say) passes full batches to the depot; one that allocates more takes them from there
+//! before carving new blocks. At exit, a thread gives all it holds to the depot.
+struct ThreadPool {
+    array<FreeBlock *, NUM_POOLED_CLASSES> loaded{};    //!< free blocks to allocate from
+    array<size_t, NUM_POOLED_CLASSES> loaded_count{};   //!< number of blocks in `loaded`
+    array<FreeBlock *, NUM_POOLED_CLASSES> spare{};     //!< a full batch of free blocks, if any
+    array<char *, NUM_POOLED_CLASSES> slab_cursors{};  //!< next never-used block in the current slab
+    array<char *, NUM_POOLED_CLASSES> slab_ends{};     //!< end of the current slab
+    BufferPool::Stats stats{};
+
+    ThreadPool() = default;
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+};
+
+thread_local ThreadPool pool{};
+
+atomic<bool> use_huge_pages{false};
+
+//! Give a batch of `count` free blocks (possibly fewer than BATCH_SIZE) to the depot
+void give_batch(const size_t index, FreeBlock *batch, const size_t count) {
+    batch->count = count;
+    lock_guard<mutex> guard{depot.lock};
+    batch->next_batch = depot.batches[index];
+    depot.batches[index] = batch;
+}
+
+//! \returns a batch of free blocks from the depot, or nullptr if it has none
+FreeBlock *take_batch(const size_t index) {
+    lock_guard<mutex> guard{depot.lock};
+    FreeBlock *batch = depot.batches[index];
+    if (batch) {
+        depot.batches[index] = batch->next_batch;
+    }
+    return batch;
+}
+
+//! \returns the unused end of a slab from the depot, or nullptr if it has none
+SlabRest *take_slab_rest(const size_t index) {
+    lock_guard<mutex> guard{depot.lock};
+    SlabRest *rest = depot.slab_rests[index];
+    if (rest) {
+        depot.slab_rests[index] = rest->next;
+    }
+    return rest;
+}
+
+ThreadPool::~ThreadPool() {
+    for (size_t index = 0; index < NUM_POOLED_CLASSES; ++index) {
+        if (loaded[index]) {
+            give_batch(index, loaded[index], loaded_count[index]);
+        }
+        if (spare[index]) {
+            give_batch(index, spare[index], BATCH_SIZE);
+        }
+        if (slab_cursors[index] != slab_ends[index]) {
+            auto *rest = new (slab_cursors[index]) SlabRest{slab_ends[index], nullptr};
+            lock_guard<mutex> guard{depot.lock};
+            rest->next = depot.slab_rests[index];
+            depot.slab_rests[index] = rest;
+        }
+        // anything freed on this thread from here on (by a later destructor) starts afresh
+        loaded[index] = spare[index] = nullptr;
+        loaded_count[index] = 0;
+        slab_cursors[index] = slab_ends[index] = nullptr;
+    }
+}
+
+char *map_slab() {
+    constexpr int prot = PROT_READ | PROT_WRITE;
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    if (use_huge_pages.load(memory_order_relaxed)) {
+        void *slab = mmap(nullptr, BufferPool::SLAB_SIZE, prot, flags | MAP_HUGETLB, -1, 0);
+        if (slab != MAP_FAILED) {
+            return static_cast<char *>(slab);
+        }
+        // no huge pages reserved; use normal pages instead
+    }
+
+    void *slab = mmap(nullptr, BufferPool::SLAB_SIZE, prot, flags, -1, 0);
+    if (slab == MAP_FAILED) {
+        throw unix_error("mmap");
+    }
+    return static_cast<char *>(slab);
+}
+
+}  // namespace
+
+//! \param[in] size is the number of bytes needed
+void *BufferPool::allocate(const size_t size, SizeClass &size_class) {
+    size_t index = 0;
+    while (index < NUM_POOLED_CLASSES and size > BLOCK_SIZES[index]) {
+        ++index;
+    }
+
+    if (index == NUM_POOLED_CLASSES) {
+        size_class = SizeClass::Heap;
+        ++pool.stats.heap_allocations;
+        return ::operator new(size);
+    }
+
+    size_class = static_cast<SizeClass>(index);
+    ++pool.stats.pool_allocations;
+
+    // reuse a freed block if there is one, from this thread or else from the depot
+    if (not pool.loaded[index]) {
+        if (pool.spare[index]) {
+            pool.loaded[index] = pool.spare[index];
+            pool.loaded_count[index] = BATCH_SIZE;
+            pool.spare[index] = nullptr;
+        } else if (FreeBlock *batch = take_batch(index)) {
+            pool.loaded[index] = batch;
+            pool.loaded_count[index] = batch->count;
+        }
+    }
+    if (FreeBlock *block = pool.loaded[index]) {
+        pool.loaded[index] = block->next;
+        --pool.loaded_count[index];
+        return block;
+    }
+
+    // otherwise carve one out of the current slab, taking up another if it's used up
+    if (pool.slab_cursors[index] == pool.slab_ends[index]) {
+        if (SlabRest *rest = take_slab_rest(index)) {
+            pool.slab_cursors[index] = reinterpret_cast<char *>(rest);
+            pool.slab_ends[index] = rest->end;
+        } else {
+            pool.slab_cursors[index] = map_slab();
+            pool.slab_ends[index] = pool.slab_cursors[index] + SLAB_SIZE;
+            ++pool.stats.slabs;
+        }
+    }
+
+    void *block = pool.slab_cursors[index];
+    pool.slab_cursors[index] += BLOCK_SIZES[index];
+    return block;
+}
+
+//! \param[in] block is the block to free
+//! \param[in] size_class is the class allocate() reported for the block
+//! \details The block joins the calling thread's free list, whichever thread allocated it.
+void BufferPool::deallocate(void *block, const SizeClass size_class) {
+    if (size_class == SizeClass::Heap) {
+        ::operator delete(block);
+        return;
+    }
+
+    const auto index = static_cast<size_t>(size_class);
+    if (pool.loaded_count[index] == BATCH_SIZE) {
+        // set the full batch aside, first passing any batch already set aside to the depot
+        if (pool.spare[index]) {
+            give_batch(index, pool.spare[index], BATCH_SIZE);
+        }
+        pool.spare[index] = pool.loaded[index];
+        pool.loaded[index] = nullptr;
+        pool.loaded_count[index] = 0;
+    }
+    pool.loaded[index] = new (block) FreeBlock{pool.loaded[index], nullptr, 0};
+    ++pool.loaded_count[index];
+}
+
+void BufferPool::set_huge_pages(const bool enabled) { use_huge_pages.store(enabled, memory_order_relaxed); }
+
+bool BufferPool::huge_pages() { return use_huge_pages.load(memory_order_relaxed); }
+
+BufferPool::Stats BufferPool::stats() { return pool.stats; }
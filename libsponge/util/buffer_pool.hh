@@ -0,0 +1,57 @@
+#ifndef SPONGE_LIBSPONGE_BUFFER_POOL_HH
+#define SPONGE_LIBSPONGE_BUFFER_POOL_HH
+
+#include <cstddef>
+#include <cstdint>
+
+//! \brief A slab allocator for the storage behind Buffer
+//! \details Requests are rounded up to one of two size classes: one that holds a set of protocol
+//! headers, and one that holds a whole Ethernet-MTU frame. Blocks are carved out of large slabs
+//! (optionally backed by huge pages) and recycled through per-thread free lists, so allocating and
+//! freeing usually take no locks and make no system calls. Requests larger than a frame go to `operator new`.
+//!
+//! Slabs belong to the process: once mapped, a slab is never unmapped, and its blocks are reused for as
+//! long as the process runs. A thread carves blocks out of the slab it's working through, and a block
+//! freed on any thread joins that thread's free list. Free blocks beyond a couple of batches, and
+//! everything a thread holds when it exits (its free blocks and the unused end of its slab), go to a
+//! shared depot under a lock. A thread whose free list is empty takes a batch from the depot before
+//! carving a new block, so a connection's thread that frees what another allocated doesn't leave either
+//! one growing without bound.
+//!
+//! Buffer counts references without atomics, so all copies of one Buffer must be used by one thread
+//! at a time; handing a Buffer (with its copies) over to another thread is fine.
+class BufferPool {
+  public:
+    //! The size classes, plus a pseudo-class for requests that were too large for the pool
+    enum class SizeClass : uint8_t { Header = 0, MTU = 1, Heap = 2 };
+
+    static constexpr size_t HEADER_BLOCK_SIZE = 256;      //!< fits Ethernet, IPv4 and TCP headers, with options
+    static constexpr size_t MTU_BLOCK_SIZE = 2048;        //!< fits a 1500-byte IP datagram in an Ethernet frame
+    static constexpr size_t SLAB_SIZE = 2 * 1024 * 1024;  //!< size of each slab (one x86-64 huge page)
+
+    //! Allocation counters for the calling thread
+    struct Stats {
+        uint64_t pool_allocations = 0;  //!< blocks handed out by the pool
+        uint64_t heap_allocations = 0;  //!< requests passed through to `operator new`
+        uint64_t slabs = 0;             //!< slabs mapped (not counting slab ends taken from the depot)
+    };
+
+    //! \brief Allocate a block of at least `size` bytes
+    //! \param[out] size_class is set to the class the block came from, to be passed to deallocate()
+    //! \throws unix_error if a new slab can't be mapped
+    static void *allocate(const size_t size, SizeClass &size_class);
+
+    //! \brief Return a block obtained from allocate(), on any thread
+    static void deallocate(void *block, const SizeClass size_class);
+
+    //! \brief Back future slabs with huge pages (falls back to normal pages if none are reserved)
+    static void set_huge_pages(const bool enabled);
+
+    //! \returns whether future slabs will be backed by huge pages
+    static bool huge_pages();
+
+    //! \returns the allocation counters for the calling thread
+    static Stats stats();
+};
+
+#endif  // SPONGE_LIBSPONGE_BUFFER_POOL_HH
@@ -44,6 +44,30 @@ FileDescriptor::FileDescriptor(shared_ptr<FDWrapper> other_shared_ptr) : _intern
 //! \returns a copy of this FileDescriptor
 FileDescriptor FileDescriptor::duplicate() const { return FileDescriptor(_internal_fd); }
 
+//! \param[in] limit is the maximum number of bytes that will be read
+FileDescriptor::PacketReadTarget::PacketReadTarget(const size_t limit)
+    : _packet(Buffer::allocate(min(limit, BufferStorage::MAX_POOLED_CAPACITY))) {
+    thread_local string overflow;
+    overflow.resize(max(overflow.size(), limit - _packet.size()));
+
+    _iovecs[0] = {_packet.mutable_data(), _packet.size()};
+    _iovecs[1] = {overflow.data(), limit - _packet.size()};
+}
+
+//! \param[in] bytes_read is the number of bytes the read returned
+Buffer FileDescriptor::PacketReadTarget::finish(const size_t bytes_read) {
+    if (bytes_read <= _packet.size()) {
+        _packet.remove_suffix(_packet.size() - bytes_read);
+        return move(_packet);
+    }
+
+    // the read spilled past the pooled storage
+    Buffer ret = Buffer::allocate(bytes_read);
+    char *out = copy(_packet.str().begin(), _packet.str().end(), ret.mutable_data());
+    copy_n(static_cast<const char *>(_iovecs[1].iov_base), bytes_read - _packet.size(), out);
+    return ret;
+}
+
 //! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
 //! \param[out] str is the string to be read
 void FileDescriptor::read(std::string &str, const size_t limit) {
@@ -63,6 +87,26 @@ void FileDescriptor::read(std::string &str, const size_t limit) {
     register_read();
 }
 
+//! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
+//! \returns the bytes read; up to BufferStorage::MAX_POOLED_CAPACITY of them are read without a heap allocation
+Buffer FileDescriptor::read_buffer(const size_t limit) {
+    constexpr size_t BUFFER_SIZE = 1024 * 1024;  // maximum size of a read
+    const size_t size_to_read = min(BUFFER_SIZE, limit);
+    PacketReadTarget target{size_to_read};
+
+    ssize_t bytes_read = SystemCall("readv", ::readv(fd_num(), target.iovecs(), target.iovec_count()));
+    if (limit > 0 && bytes_read == 0) {
+        _internal_fd->_eof = true;
+    }
+    if (bytes_read > static_cast<ssize_t>(size_to_read)) {
+        throw runtime_error("readv() read more than requested");
+    }
+
+    register_read();
+
+    return target.finish(bytes_read);
+}
+
 //! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
 //! \returns a vector of bytes read
 string FileDescriptor::read(const size_t limit) {
@@ -45,6 +45,27 @@ class FileDescriptor {
     explicit FileDescriptor(std::shared_ptr<FDWrapper> other_shared_ptr);
 
   protected:
+    //! \brief Destination for a read of unknown length, e.g. one datagram or one TUN/TAP frame
+    //! \details Bytes land in a pooled, packet-sized Buffer; anything longer spills into per-thread
+    //! scratch space, and finish() then joins the two pieces into one (unpooled) Buffer.
+    class PacketReadTarget {
+        Buffer _packet;                  //!< Pooled storage for the first bytes read
+        std::array<iovec, 2> _iovecs{};  //!< `_packet`, then the scratch space
+
+      public:
+        //! Prepare to read up to `limit` bytes
+        explicit PacketReadTarget(const size_t limit);
+
+        //! \name Scatter list to pass to [readv(2)](\ref man2::readv) or [recvmsg(2)](\ref man2::recvmsg)
+        //!@{
+        iovec *iovecs() { return _iovecs.data(); }
+        size_t iovec_count() const { return _iovecs.size(); }
+        //!@}
+
+        //! \returns the `bytes_read` bytes that were read
+        Buffer finish(const size_t bytes_read);
+    };
+
     void register_read() { ++_internal_fd->_read_count; }    //!< increment read count
     void register_write() { ++_internal_fd->_write_count; }  //!< increment write count
 
@@ -61,6 +82,9 @@ class FileDescriptor {
     //! Read up to `limit` bytes into `str` (caller can allocate storage)
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read up to `limit` bytes into pooled storage (best for packet-at-a-time devices such as TUN/TAP)
+    Buffer read_buffer(const size_t limit = std::numeric_limits<size_t>::max());
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
@@ -12,6 +12,8 @@ string as_string(const ParseResult r) {
         "WrongIPVersion",
         "HeaderTooShort",
         "TruncatedPacket",
+        "Unsupported",
+        "BadOption",
     };
 
     return _names[static_cast<size_t>(r)];
@@ -59,6 +61,14 @@ void NetUnparser::_unparse_int(string &s, T val) {
     }
 }
 
+template <typename T>
+void NetUnparser::_unparse_int(char *&out, T val) {
+    constexpr size_t len = sizeof(T);
+    for (size_t i = 0; i < len; ++i) {
+        *out++ = static_cast<char>((val >> ((len - i - 1) * 8)) & 0xff);
+    }
+}
+
 uint32_t NetParser::u32() { return _parse_int<uint32_t>(); }
 
 uint16_t NetParser::u16() { return _parse_int<uint16_t>(); }
@@ -70,3 +80,9 @@ void NetUnparser::u32(string &s, const uint32_t val) { return _unparse_int<uint3
 void NetUnparser::u16(string &s, const uint16_t val) { return _unparse_int<uint16_t>(s, val); }
 
 void NetUnparser::u8(string &s, const uint8_t val) { return _unparse_int<uint8_t>(s, val); }
+
+void NetUnparser::u32(char *&out, const uint32_t val) { return _unparse_int<uint32_t>(out, val); }
+
+void NetUnparser::u16(char *&out, const uint16_t val) { return _unparse_int<uint16_t>(out, val); }
+
+void NetUnparser::u8(char *&out, const uint8_t val) { return _unparse_int<uint8_t>(out, val); }
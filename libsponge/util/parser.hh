@@ -16,7 +16,8 @@ enum class ParseResult {
     WrongIPVersion,   //!< Got a version of IP other than 4
     HeaderTooShort,   //!< Header length is shorter than minimum required
     TruncatedPacket,  //!< Packet length is shorter than header claims
-    Unsupported       //!< Packet uses unsupported features
+    Unsupported,      //!< Packet uses unsupported features
+    BadOption         //!< A header option's length is too short or runs past the header
 };
 
 //! Output a string representation of a ParseResult
@@ -74,6 +75,16 @@ struct NetUnparser {
 
     //! Write an 8-bit integer into the data stream in network byte order
     static void u8(std::string &s, const uint8_t val);
+
+    template <typename T>
+    static void _unparse_int(char *&out, T val);
+
+    //! \name Write an integer in network byte order to `out`, advancing it past the written bytes
+    //!@{
+    static void u32(char *&out, const uint32_t val);
+    static void u16(char *&out, const uint16_t val);
+    static void u8(char *&out, const uint8_t val);
+    //!@}
 };
 
 #endif  // SPONGE_LIBSPONGE_PARSER_HH
@@ -0,0 +1,51 @@
+#include "ring_buffer.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+//! \param[in] data is the string to copy; bytes beyond the free space are not copied
+size_t RingBuffer::write(string_view data) {
+    const size_t len = min(data.size(), capacity() - _size);
+    if (len == 0) {
+        return 0;
+    }
+
+    // the free region starts right after the readable bytes and may wrap around
+    const size_t tail = (_head + _size) % capacity();
+    const size_t first = min(len, capacity() - tail);
+    data.copy(_storage.data() + tail, first);
+    data.copy(_storage.data(), len - first, first);
+
+    _size += len;
+    return len;
+}
+
+//! \param[out] out is the string the bytes are appended to
+//! \param[in] len is the number of bytes to copy; at most size() bytes are copied
+void RingBuffer::peek(string &out, const size_t len) const {
+    const size_t n = min(len, _size);
+    const size_t first = min(n, capacity() - _head);
+    out.append(_storage, _head, first);
+    out.append(_storage, 0, n - first);
+}
+
+//! \param[in] len is the number of bytes to view; at most size() bytes are viewed
+pair<string_view, string_view> RingBuffer::peek_view(const size_t len) const {
+    const size_t n = min(len, _size);
+    const size_t first = min(n, capacity() - _head);
+    return {{_storage.data() + _head, first}, {_storage.data(), n - first}};
+}
+
+//! \param[in] n is the number of bytes to discard
+void RingBuffer::remove_prefix(const size_t n) {
+    if (n > _size) {
+        throw out_of_range("RingBuffer::remove_prefix");
+    }
+    if (n == 0) {
+        return;
+    }
+    _head = (_head + n) % capacity();
+    _size -= n;
+}
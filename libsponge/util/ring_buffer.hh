@@ -0,0 +1,45 @@
+#ifndef SPONGE_LIBSPONGE_RING_BUFFER_HH
+#define SPONGE_LIBSPONGE_RING_BUFFER_HH
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//! \brief A fixed-capacity circular byte buffer
+//! \details The storage is allocated once, at construction. Writing, peeking and
+//! discarding bytes never allocate; they copy into or out of the existing storage.
+class RingBuffer {
+  private:
+    std::string _storage;  //!< Backing storage, `capacity` bytes long
+    size_t _head{0};       //!< Index in `_storage` of the first readable byte
+    size_t _size{0};       //!< Number of readable bytes
+
+  public:
+    //! \brief Construct a ring buffer with room for `capacity` bytes
+    explicit RingBuffer(const size_t capacity = 0) : _storage(capacity, '\0') {}
+
+    //! \brief Copy as much of `data` as fits into the back of the buffer
+    //! \returns the number of bytes copied
+    size_t write(std::string_view data);
+
+    //! \brief Append the first `len` readable bytes to `out`
+    //! \note `out` is not cleared first; it only allocates if it lacks the capacity
+    void peek(std::string &out, const size_t len) const;
+
+    //! \brief View the first `len` readable bytes without copying them
+    //! \returns the bytes as two contiguous pieces (the second is empty unless the bytes wrap around)
+    //! \note The views are invalidated by the next call to remove_prefix()
+    std::pair<std::string_view, std::string_view> peek_view(const size_t len) const;
+
+    //! \brief Discard the first `n` readable bytes
+    void remove_prefix(const size_t n);
+
+    //! \returns the number of readable bytes
+    size_t size() const { return _size; }
+
+    //! \returns the total number of bytes the buffer can hold
+    size_t capacity() const { return _storage.size(); }
+};
+
+#endif  // SPONGE_LIBSPONGE_RING_BUFFER_HH
@@ -0,0 +1,172 @@
+#ifndef SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+#define SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//! \brief A sequence that keeps up to `N` elements inline, spilling to the heap only when it grows past that
+//! \details Supports appending at the back and removing from the front (each amortized O(1)),
+//! which is how BufferList and BufferViewList use it. The elements are always contiguous, so
+//! data() can be handed straight to [writev(2)](\ref man2::writev).
+template <typename T, size_t N>
+class SmallVector {
+  private:
+    std::array<T, N> _inline{};  //!< Storage while the elements fit
+    std::vector<T> _heap{};      //!< Storage once they have spilled
+    bool _on_heap{false};        //!< Whether the elements live in `_heap`
+    size_t _head{0};             //!< Index of the first element
+    size_t _tail{0};             //!< Index one past the last element
+
+    T *_storage() { return _on_heap ? _heap.data() : _inline.data(); }
+    const T *_storage() const { return _on_heap ? _heap.data() : _inline.data(); }
+
+    //! Move the elements to the heap, leaving room to grow
+    void _spill() {
+        _heap.reserve(2 * N);
+        for (size_t i = _head; i < _tail; i++) {
+            _heap.push_back(std::move(_inline[i]));
+            _inline[i] = T{};
+        }
+        _on_heap = true;
+        _tail -= _head;
+        _head = 0;
+    }
+
+    //! Leave this vector empty, with its elements inline, after its storage has been moved away
+    void _reset_moved_from() {
+        std::fill(_inline.begin(), _inline.end(), T{});
+        _heap.clear();
+        _on_heap = false;
+        _head = _tail = 0;
+    }
+
+  public:
+    SmallVector() = default;
+
+    //! \name Copy/move constructor/assignment operators
+    //! A moved-from SmallVector is empty
+    //!@{
+    SmallVector(const SmallVector &other) = default;
+    SmallVector &operator=(const SmallVector &other) = default;
+
+    SmallVector(SmallVector &&other) noexcept
+        : _inline(std::move(other._inline))
+        , _heap(std::move(other._heap))
+        , _on_heap(other._on_heap)
+        , _head(other._head)
+        , _tail(other._tail) {
+        other._reset_moved_from();
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            _inline = std::move(other._inline);
+            _heap = std::move(other._heap);
+            _on_heap = other._on_heap;
+            _head = other._head;
+            _tail = other._tail;
+            other._reset_moved_from();
+        }
+        return *this;
+    }
+    //!@}
+
+    ~SmallVector() = default;
+
+    //! \name Element access
+    //!@{
+    T *data() { return _storage() + _head; }
+    const T *data() const { return _storage() + _head; }
+
+    T *begin() { return data(); }
+    T *end() { return _storage() + _tail; }
+    const T *begin() const { return data(); }
+    const T *end() const { return _storage() + _tail; }
+
+    T &front() { return *data(); }
+    const T &front() const { return *data(); }
+    T &back() { return *(end() - 1); }
+    const T &back() const { return *(end() - 1); }
+
+    T &operator[](const size_t i) { return data()[i]; }
+    const T &operator[](const size_t i) const { return data()[i]; }
+    //!@}
+
+    //! \returns the number of elements
+    size_t size() const { return _tail - _head; }
+
+    //! \returns `true` if there are no elements
+    bool empty() const { return _tail == _head; }
+
+    //! \brief Append an element
+    void push_back(T value) {
+        if (not _on_heap) {
+            if (_tail < N) {
+                _inline[_tail++] = std::move(value);
+                return;
+            }
+            if (_head == 0) {
+                _spill();
+            } else {
+                // slide the remaining elements back to the start of the inline storage
+                std::move(_inline.begin() + _head, _inline.begin() + _tail, _inline.begin());
+                std::fill(_inline.begin() + (_tail - _head), _inline.begin() + _tail, T{});
+                _tail -= _head;
+                _head = 0;
+                _inline[_tail++] = std::move(value);
+                return;
+            }
+        } else if (_tail == _heap.capacity() and _head >= _tail / 2) {
+            // reclaim the space left by pop_front() rather than growing
+            _heap.erase(_heap.begin(), _heap.begin() + _head);
+            _tail -= _head;
+            _head = 0;
+        }
+
+        _heap.push_back(std::move(value));
+        _tail++;
+    }
+
+    //! \brief Insert an element at the front
+    //! \note O(1) if there is room left by pop_front(), otherwise O(size())
+    void push_front(T value) {
+        if (_head > 0) {
+            _storage()[--_head] = std::move(value);
+            return;
+        }
+
+        SmallVector rebuilt;
+        rebuilt.push_back(std::move(value));
+        for (auto &x : *this) {
+            rebuilt.push_back(std::move(x));
+        }
+        *this = std::move(rebuilt);
+    }
+
+    //! \brief Remove the first element
+    void pop_front() {
+        if (empty()) {
+            throw std::out_of_range("SmallVector::pop_front");
+        }
+        _storage()[_head++] = T{};
+        if (_head == _tail) {
+            clear();
+        }
+    }
+
+    //! \brief Remove all elements (heap storage, if any, is kept for reuse)
+    void clear() {
+        if (_on_heap) {
+            _heap.clear();
+        } else {
+            std::fill(_inline.begin() + _head, _inline.begin() + _tail, T{});
+        }
+        _head = _tail = 0;
+    }
+};
+
+#endif  // SPONGE_LIBSPONGE_SMALL_VECTOR_HH
@@ -106,6 +106,28 @@ void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
     datagram.payload.resize(recv_len);
 }
 
+//! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
+UDPSocket::received_buffer UDPSocket::recv_buffer(const size_t mtu) {
+    // receive source address and payload
+    Address::Raw datagram_source_address;
+    PacketReadTarget target{mtu};
+
+    msghdr message{};
+    message.msg_name = datagram_source_address;
+    message.msg_namelen = sizeof(datagram_source_address);
+    message.msg_iov = target.iovecs();
+    message.msg_iovlen = target.iovec_count();
+
+    const ssize_t recv_len = SystemCall("recvmsg", ::recvmsg(fd_num(), &message, MSG_TRUNC));
+
+    if (recv_len > ssize_t(mtu)) {
+        throw runtime_error("recvmsg (oversized datagram)");
+    }
+
+    register_read();
+    return {{datagram_source_address, message.msg_namelen}, target.finish(recv_len)};
+}
+
 UDPSocket::received_datagram UDPSocket::recv(const size_t mtu) {
     received_datagram ret{{nullptr, 0}, ""};
     recv(ret, mtu);
@@ -70,6 +70,15 @@ class UDPSocket : public Socket {
     //! Receive a datagram and the Address of its sender (caller can allocate storage)
     void recv(received_datagram &datagram, const size_t mtu = 65536);
 
+    //! Returned by UDPSocket::recv_buffer; like received_datagram, but the payload is in pooled storage
+    struct received_buffer {
+        Address source_address;  //!< Address from which this datagram was received
+        Buffer payload;          //!< UDP datagram payload
+    };
+
+    //! Receive a datagram and the Address of its sender, without a heap allocation for typical datagrams
+    received_buffer recv_buffer(const size_t mtu = 65536);
+
     //! Send a datagram to specified Address
     void sendto(const Address &destination, const BufferViewList &payload);
 
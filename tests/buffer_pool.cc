@@ -0,0 +1,169 @@
+#include "buffer.hh"
+#include "buffer_pool.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//! A Buffer of `len` bytes from the pool, filled with `c`
+static Buffer filled(const size_t len, const char c) {
+    Buffer buffer = Buffer::allocate(len);
+    memset(buffer.mutable_data(), c, len);
+    return buffer;
+}
+
+//! \returns whether mutable_data() lets `buffer` be written, i.e. no other Buffer shares its storage
+static bool writable(Buffer &buffer) {
+    try {
+        buffer.mutable_data();
+        return true;
+    } catch (const runtime_error &) {
+        return false;
+    }
+}
+
+//! Run `work` on a thread of its own, and wait for the thread to exit
+template <typename Work>
+static void on_new_thread(Work work) {
+    exception_ptr error{};
+    thread t{[&] {
+        try {
+            work();
+        } catch (...) {
+            error = current_exception();
+        }
+    }};
+    t.join();
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+int main() {
+    try {
+        // a freed block is the next one handed out in its size class
+        {
+            const auto before = BufferPool::stats();
+            BufferPool::SizeClass size_class{};
+            void *block = BufferPool::allocate(100, size_class);
+            test_should_be(size_class == BufferPool::SizeClass::Header, true);
+            BufferPool::deallocate(block, size_class);
+            test_should_be(BufferPool::allocate(BufferPool::HEADER_BLOCK_SIZE, size_class) == block, true);
+            BufferPool::deallocate(block, size_class);
+
+            void *frame = BufferPool::allocate(BufferPool::HEADER_BLOCK_SIZE + 1, size_class);
+            test_should_be(size_class == BufferPool::SizeClass::MTU, true);
+            BufferPool::deallocate(frame, size_class);
+            test_should_be(BufferPool::stats().pool_allocations - before.pool_allocations, uint64_t{3});
+            test_should_be(BufferPool::stats().heap_allocations - before.heap_allocations, uint64_t{0});
+        }
+
+        // requests larger than a frame go to operator new, for Buffers too
+        {
+            const auto before = BufferPool::stats();
+            BufferPool::SizeClass size_class{};
+            void *block = BufferPool::allocate(BufferPool::MTU_BLOCK_SIZE + 1, size_class);
+            test_should_be(size_class == BufferPool::SizeClass::Heap, true);
+            BufferPool::deallocate(block, size_class);
+
+            Buffer big = filled(BufferStorage::MAX_POOLED_CAPACITY + 1, 'b');
+            test_should_be(big.size(), BufferStorage::MAX_POOLED_CAPACITY + 1);
+            test_should_be(big.at(BufferStorage::MAX_POOLED_CAPACITY), uint8_t{'b'});
+            test_should_be(BufferPool::stats().heap_allocations - before.heap_allocations, uint64_t{2});
+
+            Buffer small = filled(BufferStorage::MAX_POOLED_CAPACITY, 's');
+            test_should_be(BufferPool::stats().heap_allocations - before.heap_allocations, uint64_t{2});
+        }
+
+        // a slice or a copy keeps the storage alive after the original goes
+        {
+            Buffer slice, copy;
+            {
+                Buffer original = filled(1000, 'a');
+                original.mutable_data()[500] = 'z';
+                slice = original.slice(500, 10);
+                copy = original;
+            }
+            // blocks freed now would be handed out again here, and overwritten
+            const Buffer others[] = {filled(1000, 'x'), filled(1000, 'y')};
+            test_should_be(slice.copy() == "z" + string(9, 'a'), true);
+            test_should_be(copy.size(), size_t{1000});
+            test_should_be(copy.at(500), uint8_t{'z'});
+            test_should_be(others[0].at(0), uint8_t{'x'});
+        }
+
+        // storage is shared while more than one Buffer refers to it, and writable again once the rest are gone
+        {
+            BufferStorage *storage = BufferStorage::allocate(100);
+            test_should_be(storage->shared(), false);
+            storage->retain();
+            test_should_be(storage->shared(), true);
+            storage->release();
+            test_should_be(storage->shared(), false);
+            storage->release();
+
+            Buffer buffer = filled(100, 'a');
+            test_should_be(writable(buffer), true);
+            {
+                const Buffer slice = buffer.slice(10, 10);
+                test_should_be(writable(buffer), false);
+            }
+            test_should_be(writable(buffer), true);
+        }
+
+        // a thread's free blocks and the rest of its slab outlive it, for the next thread to use
+        {
+            void *freed = nullptr;
+            on_new_thread([&] {
+                BufferPool::SizeClass size_class{};
+                freed = BufferPool::allocate(BufferPool::MTU_BLOCK_SIZE, size_class);
+                BufferPool::deallocate(freed, size_class);
+                test_should_be(BufferPool::stats().slabs, uint64_t{1});
+            });
+            on_new_thread([&] {
+                BufferPool::SizeClass size_class{};
+                void *reused = BufferPool::allocate(BufferPool::MTU_BLOCK_SIZE, size_class);
+                test_should_be(reused == freed, true);
+                void *carved = BufferPool::allocate(BufferPool::MTU_BLOCK_SIZE, size_class);
+                test_should_be(BufferPool::stats().slabs, uint64_t{0});
+                BufferPool::deallocate(carved, size_class);
+                BufferPool::deallocate(reused, size_class);
+            });
+        }
+
+        // blocks freed on another thread find their way back to the thread that allocates them
+        {
+            constexpr size_t BLOCKS_PER_SLAB = BufferPool::SLAB_SIZE / BufferPool::MTU_BLOCK_SIZE;
+            on_new_thread([&] {
+                for (unsigned round = 0; round < 4; round++) {
+                    vector<void *> blocks;
+                    BufferPool::SizeClass size_class{};
+                    for (size_t i = 0; i < BLOCKS_PER_SLAB; i++) {
+                        blocks.push_back(BufferPool::allocate(BufferPool::MTU_BLOCK_SIZE, size_class));
+                    }
+                    on_new_thread([&] {
+                        for (void *block : blocks) {
+                            BufferPool::deallocate(block, size_class);
+                        }
+                    });
+                }
+                // without the depot, each round would have taken a slab (or more) of its own
+                test_should_be(BufferPool::stats().slabs <= 2, true);
+            });
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
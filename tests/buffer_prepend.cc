@@ -0,0 +1,124 @@
+#include "buffer.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+#include "test_should_be.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+//! A Buffer holding `len` bytes of 'p', with `headroom` bytes reserved in front
+static Buffer payload(const size_t len, const size_t headroom) {
+    Buffer buffer = Buffer::allocate(len, headroom);
+    memset(buffer.mutable_data(), 'p', len);
+    return buffer;
+}
+
+//! A segment carrying `data`
+static TCPSegment segment(Buffer data) {
+    TCPSegment seg;
+    seg.header().ack = true;
+    seg.header().win = 1000;
+    seg.payload() = move(data);
+    return seg;
+}
+
+//! \returns whether `packet` is one contiguous Buffer that ends with the very bytes of `data`
+static bool ends_in_place(const BufferList &packet, const Buffer &data) {
+    if (packet.buffers().size() != 1) {
+        return false;
+    }
+    const string_view bytes = packet.buffers().front().str();
+    return bytes.data() + bytes.size() - data.size() == data.str().data();
+}
+
+int main() {
+    try {
+        // prepend() takes bytes from the headroom, in front of the ones already claimed
+        {
+            Buffer buffer = payload(10, 20);
+            test_should_be(buffer.can_prepend(20), true);
+            test_should_be(buffer.can_prepend(21), false);
+            const char *const start = buffer.str().data();
+
+            const Buffer before = buffer;
+            char *const header = buffer.prepend(8);
+            test_should_be(header == start - 8, true);
+            memset(header, 'h', 8);
+            test_should_be(buffer.copy() == string(8, 'h') + string(10, 'p'), true);
+            test_should_be(before.size(), size_t{10});
+
+            // the claimed bytes are gone from the headroom, for this Buffer and any other
+            test_should_be(buffer.can_prepend(12), true);
+            test_should_be(buffer.can_prepend(13), false);
+            test_should_be(before.can_prepend(1), false);
+
+            bool threw = false;
+            try {
+                buffer.prepend(13);
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            test_should_be(threw, true);
+        }
+
+        // a Buffer without headroom can't grow at the front; a BufferList puts the bytes in a Buffer of their own
+        {
+            Buffer plain{string("payload")};
+            test_should_be(plain.can_prepend(1), false);
+            test_should_be(Buffer{}.can_prepend(0), false);
+
+            BufferList list{plain};
+            memcpy(list.prepend(3), "hdr", 3);
+            test_should_be(list.buffers().size(), size_t{2});
+            test_should_be(list.concatenate() == "hdrpayload", true);
+
+            BufferList roomy{payload(4, 3)};
+            memcpy(roomy.prepend(3), "hdr", 3);
+            test_should_be(roomy.buffers().size(), size_t{1});
+            test_should_be(roomy.size(), size_t{7});
+            test_should_be(roomy.concatenate() == "hdrpppp", true);
+        }
+
+        // wrapping a segment puts its headers in front of its payload in place, unless the payload's storage is
+        // shared or lacks the headroom; either way the packet is one Buffer with the same bytes
+        {
+            TCPOverIPv4Adapter adapter;
+            const size_t len = 500, headroom = TCPOverIPv4Adapter::PACKET_HEADROOM;
+
+            TCPSegment copied = segment(payload(len, 0));
+            const string expected = adapter.wrap_tcp_in_ip(copied).serialize().concatenate();
+            test_should_be(ends_in_place(adapter.wrap_tcp_in_ip(copied).serialize(), copied.payload()), false);
+
+            TCPSegment roomy = segment(payload(len, headroom));
+            const BufferList packet = adapter.wrap_tcp_in_ip(roomy).serialize();
+            test_should_be(ends_in_place(packet, roomy.payload()), true);
+            test_should_be(packet.concatenate() == expected, true);
+
+            // wrapped again (as on a retransmission), its headroom is taken, so the payload is copied
+            const BufferList again = adapter.wrap_tcp_in_ip(roomy).serialize();
+            test_should_be(ends_in_place(again, roomy.payload()), false);
+            test_should_be(again.concatenate() == expected, true);
+
+            TCPSegment shared = segment(payload(len, headroom));
+            const Buffer other = shared.payload();
+            const BufferList shared_packet = adapter.wrap_tcp_in_ip(shared).serialize();
+            test_should_be(ends_in_place(shared_packet, shared.payload()), false);
+            test_should_be(shared_packet.buffers().size(), size_t{1});
+            test_should_be(shared_packet.concatenate() == expected, true);
+            test_should_be(other.can_prepend(headroom), true);
+
+            TCPSegment empty = segment(Buffer{});
+            test_should_be(adapter.wrap_tcp_in_ip(empty).serialize().buffers().size(), size_t{1});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
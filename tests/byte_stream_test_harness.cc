@@ -46,7 +46,7 @@ void ByteStreamAction::execute(ByteStream &) const {}
 ByteStreamAction::~ByteStreamAction() {}
 
 ByteStreamTestHarness::ByteStreamTestHarness(const std::string &test_name, const size_t capacity)
-    : _test_name(test_name), _byte_stream(capacity) {
+    : _test_name(test_name), _byte_stream(capacity), _ring_byte_stream(capacity, ByteStream::Backend::Ring) {
     std::ostringstream ss;
     ss << "Initialized with ("
        << "capacity=" << capacity << ")";
@@ -56,6 +56,7 @@ ByteStreamTestHarness::ByteStreamTestHarness(const std::string &test_name, const
 void ByteStreamTestHarness::execute(const ByteStreamTestStep &step) {
     try {
         step.execute(_byte_stream);
+        step.execute(_ring_byte_stream);
         _steps_executed.emplace_back(step);
     } catch (const ByteStreamExpectationViolation &e) {
         std::cerr << "Test Failure on expectation:\n\t" << std::string(step);
@@ -181,4 +182,13 @@ void Peek::execute(ByteStream &bs) const {
         throw ByteStreamExpectationViolation("Expected \"" + _output + "\" at the front of the stream, but found \"" +
                                              output + "\"");
     }
+    const auto view = bs.peek_output_view(_output.size());
+    string view_output;
+    for (const auto &iov : view.as_iovecs()) {
+        view_output.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    }
+    if (view_output != _output) {
+        throw ByteStreamExpectationViolation("Expected \"" + _output + "\" in the view of the stream, but found \"" +
+                                             view_output + "\"");
+    }
 }
@@ -131,6 +131,7 @@ struct Peek : public ByteStreamExpectation {
 class ByteStreamTestHarness {
     std::string _test_name;
     ByteStream _byte_stream;
+    ByteStream _ring_byte_stream;  //!< Same steps, run against ByteStream::Backend::Ring
     std::vector<std::string> _steps_executed{};
 
   public:
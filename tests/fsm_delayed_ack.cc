@@ -0,0 +1,116 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+constexpr uint16_t ACK_DELAY = 40;
+
+//! A configuration that delays acks by `ack_delay`
+static TCPConfig config_with_ack_delay(const optional<uint16_t> ack_delay) {
+    TCPConfig config;
+    config.ack_delay = ack_delay;
+    return config;
+}
+
+int main() {
+    try {
+        // the largest payload, beside the timestamps every segment carries
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE - TCPHeader::TIMESTAMPS_LENGTH;
+
+        // a lone segment is acknowledged once the delay has passed
+        {
+            TCPConnection x{TCPConfig{}}, y{config_with_ack_delay(ACK_DELAY)};
+            handshake(x, y);
+
+            x.write("hello");
+            const TCPSegment data = take_segment(x);
+            y.segment_received(data);
+            test_should_be(y.segments_out().size(), size_t{0});
+            y.tick(ACK_DELAY - 1);
+            test_should_be(y.segments_out().size(), size_t{0});
+            y.tick(1);
+            test_should_be(take_segment(y).header().ackno, data.header().seqno + 5);
+        }
+
+        // every second segment is acknowledged at once
+        {
+            TCPConnection x{TCPConfig{}}, y{config_with_ack_delay(ACK_DELAY)};
+            handshake(x, y);
+
+            x.write(string(4 * MSS, 'x'));
+            test_should_be(x.segments_out().size(), size_t{4});
+            deliver(x, y);
+            test_should_be(y.segments_out().size(), size_t{2});
+            y.tick(ACK_DELAY);
+            test_should_be(y.segments_out().size(), size_t{2});
+        }
+
+        // segments out of order, and the one that fills the gap, are acknowledged at once
+        {
+            TCPConnection x{TCPConfig{}}, y{config_with_ack_delay(ACK_DELAY)};
+            handshake(x, y);
+
+            x.write(string(3 * MSS, 'x'));
+            const TCPSegment first = take_segment(x);
+            y.segment_received(take_segment(x));
+            test_should_be(y.segments_out().size(), size_t{1});
+            y.segment_received(first);
+            test_should_be(y.segments_out().size(), size_t{2});
+            y.segment_received(take_segment(x));
+            test_should_be(y.segments_out().size(), size_t{2});
+        }
+
+        // a FIN is acknowledged at once
+        {
+            TCPConnection x{TCPConfig{}}, y{config_with_ack_delay(ACK_DELAY)};
+            handshake(x, y);
+
+            x.end_input_stream();
+            deliver(x, y);
+            test_should_be(y.segments_out().size(), size_t{1});
+        }
+
+        // data going the other way carries the ack, and none goes alone
+        {
+            TCPConnection x{TCPConfig{}}, y{config_with_ack_delay(ACK_DELAY)};
+            handshake(x, y);
+
+            x.write("ping");
+            const TCPSegment ping = take_segment(x);
+            y.segment_received(ping);
+            y.tick(ACK_DELAY / 2);
+            y.write("pong");
+            const TCPSegment pong = take_segment(y);
+            test_should_be(pong.payload().size(), size_t{4});
+            test_should_be(pong.header().ackno, ping.header().seqno + 4);
+            y.tick(ACK_DELAY);
+            test_should_be(y.segments_out().size(), size_t{0});
+        }
+
+        // without a delay, every segment is acknowledged
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.write(string(4 * MSS, 'x'));
+            test_should_be(x.segments_out().size(), size_t{4});
+            deliver(x, y);
+            test_should_be(y.segments_out().size(), size_t{4});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include "cubic_controller.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Check that `conn` has sent segments with these payload sizes, dequeuing them
+static void expect_payload_sizes(TCPConnection &conn, const vector<size_t> &expected) {
+    for (const size_t size : expected) {
+        test_should_be(conn.segments_out().empty(), false);
+        test_should_be(conn.segments_out().front().payload().size(), size);
+        conn.segments_out().pop();
+    }
+    test_should_be(conn.segments_out().empty(), true);
+}
+
+//! A configuration with the given MSS
+static TCPConfig config_with_mss(const optional<size_t> mss) {
+    TCPConfig config;
+    config.mss = mss;
+    return config;
+}
+
+int main() {
+    try {
+        // the room each segment's timestamps take from its payload
+        const size_t TS = TCPHeader::TIMESTAMPS_LENGTH;
+
+        // the option survives serialization, beside the other SYN options
+        {
+            TCPHeader header;
+            header.syn = true;
+            header.mss = 1460;
+            header.window_scale = 7;
+            header.sack_permitted = true;
+            test_should_be(header.length(), TCPHeader::LENGTH + 12);
+
+            TCPHeader parsed;
+            NetParser parser{header.serialize()};
+            if (parsed.parse(parser) != ParseResult::NoError) {
+                throw runtime_error("failed to parse a serialized header");
+            }
+            test_should_be(parsed.mss.value(), uint16_t{1460});
+            test_should_be(parsed.window_scale.value(), uint8_t{7});
+            test_should_be(parsed.sack_permitted, true);
+        }
+
+        // each side gives its MSS on its SYN, and both send segments of the smaller
+        {
+            TCPConnection x{config_with_mss(1460)}, y{config_with_mss(536)};
+            x.connect();
+            test_should_be(deliver(x, y).value().mss.value(), uint16_t{1460});
+            test_should_be(deliver(y, x).value().mss.value(), uint16_t{536});
+            deliver(x, y);
+
+            x.write(string(1200, 'x'));
+            expect_payload_sizes(x, {536 - TS, 536 - TS, 128 + 2 * TS});
+            y.write(string(1200, 'y'));
+            expect_payload_sizes(y, {536 - TS, 536 - TS, 128 + 2 * TS});
+        }
+
+        // without a configured MSS, a connection gives and sends MAX_PAYLOAD_SIZE
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            x.connect();
+            test_should_be(deliver(x, y).value().mss.value(), uint16_t{TCPConfig::MAX_PAYLOAD_SIZE});
+            deliver(y, x);
+            deliver(x, y);
+
+            x.write(string(1500, 'x'));
+            expect_payload_sizes(x, {TCPConfig::MAX_PAYLOAD_SIZE - TS, 500 + TS});
+        }
+
+        // a peer that gives no MSS is sent segments of our own
+        {
+            TCPConnection x{config_with_mss(1460)}, y{config_with_mss(536)};
+            x.connect();
+            deliver(x, y);
+            deliver(y, x, [](TCPHeader &header) { header.mss.reset(); });
+            deliver(x, y);
+
+            x.write(string(1500, 'x'));
+            expect_payload_sizes(x, {1460 - TS, 40 + TS});
+        }
+
+        // without timestamps, a segment's payload is the whole MSS
+        {
+            TCPConfig config = config_with_mss(536);
+            config.timestamps = false;
+            TCPConnection x{config}, y{config};
+            x.connect();
+            deliver(x, y);
+            deliver(y, x);
+            deliver(x, y);
+
+            x.write(string(600, 'x'));
+            expect_payload_sizes(x, {536, 64});
+        }
+
+        // a full segment fits in the MTU the MSS was taken from, with its timestamps and the SACK blocks it
+        // reports
+        {
+            const size_t mtu = 1500;
+            TCPConfig config = config_with_mss(mtu - IPv4Header::LENGTH - TCPHeader::LENGTH);
+            TCPConnection x{config}, y{config};
+            x.connect();
+            deliver(x, y);
+            deliver(y, x);
+            deliver(x, y);
+
+            const auto fits = [&](const TCPSegment &seg) {
+                test_should_be(IPv4Header::LENGTH + seg.header().length() + seg.payload().size() <= mtu, true);
+            };
+            x.write(string(3000, 'x'));
+            test_should_be(x.segments_out().front().header().has_timestamps, true);
+            test_should_be(x.segments_out().front().payload().size(), config.mss.value() - TS);
+            fits(x.segments_out().front());
+            deliver(x, y);
+            deliver(y, x);
+
+            // x hears of y's data with a gap in it, so reports a SACK block on what it sends next
+            y.write(string(3 * (config.mss.value() - TS), 'y'));
+            y.segments_out().pop();
+            deliver(y, x);
+            x.segments_out() = {};
+            x.write(string(3000, 'x'));
+            test_should_be(x.segments_out().front().header().num_sack_blocks, uint8_t{1});
+            while (not x.segments_out().empty()) {
+                fits(x.segments_out().front());
+                x.segments_out().pop();
+            }
+        }
+
+        // a controller that counts its window in segments keeps its size in bytes across a change of MSS
+        {
+            CubicController cubic{1000, 10000};
+            cubic.set_mss(536);
+            test_should_be(cubic.cwnd(), size_t{10000});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
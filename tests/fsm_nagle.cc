@@ -0,0 +1,135 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_segment.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! Check that `conn` has sent segments with these payloads, dequeuing them
+static void expect_payloads(TCPConnection &conn, const vector<string> &expected) {
+    for (const string &payload : expected) {
+        test_should_be(conn.segments_out().empty(), false);
+        const string sent = conn.segments_out().front().payload().copy();
+        if (sent != payload) {
+            throw runtime_error("expected a segment carrying \"" + payload + "\", but it carried \"" + sent + "\"");
+        }
+        conn.segments_out().pop();
+    }
+    test_should_be(conn.segments_out().empty(), true);
+}
+
+//! A configuration with the given variant of Nagle's algorithm
+static TCPConfig config_with_nagle(const TCPConfig::Nagle nagle) {
+    TCPConfig config;
+    config.nagle = nagle;
+    return config;
+}
+
+int main() {
+    try {
+        // the largest payload, beside the timestamps every segment carries
+        const size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE - TCPHeader::TIMESTAMPS_LENGTH;
+
+        // with Nagle's algorithm, small writes wait while data is unacknowledged, then go out together
+        {
+            TCPConnection x{config_with_nagle(TCPConfig::Nagle::On)}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.write("a");
+            x.write("b");
+            x.write("c");
+            const TCPSegment first = x.segments_out().front();
+            expect_payloads(x, {"a"});
+
+            y.segment_received(first);
+            deliver(y, x);
+            expect_payloads(x, {"bc"});
+        }
+
+        // full segments aren't held back, but the short one after them is
+        {
+            TCPConnection x{config_with_nagle(TCPConfig::Nagle::On)}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.write(string(MSS, 'x'));
+            x.write(string(MSS + 10, 'y'));
+            expect_payloads(x, {string(MSS, 'x'), string(MSS, 'y')});
+        }
+
+        // by Minshall's variant, a short segment waits only for an earlier short one
+        {
+            TCPConnection x{config_with_nagle(TCPConfig::Nagle::Minshall)}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.write(string(MSS + 10, 'x'));
+            test_should_be(x.segments_out().size(), size_t{2});
+            deliver(x, y);
+            x.write("a");
+            x.write("b");
+            test_should_be(x.segments_out().size(), size_t{0});
+
+            deliver(y, x);
+            expect_payloads(x, {"ab"});
+        }
+
+        // without it, every write goes out at once
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.write("a");
+            x.write("b");
+            expect_payloads(x, {"a", "b"});
+        }
+
+        // corked, only full segments go out, whatever is in flight; uncorking sends the rest
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.cork();
+            x.write("a");
+            test_should_be(x.segments_out().size(), size_t{0});
+            x.write(string(MSS, 'b'));
+            expect_payloads(x, {"a" + string(MSS - 1, 'b')});
+            x.uncork();
+            test_should_be(x.corked(), false);
+            expect_payloads(x, {"b"});
+        }
+
+        // the end of the stream flushes a corked connection
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.cork();
+            x.write("bye");
+            test_should_be(x.segments_out().size(), size_t{0});
+            x.end_input_stream();
+            test_should_be(x.segments_out().front().header().fin, true);
+            expect_payloads(x, {"bye"});
+        }
+
+        // uncorking before connecting sends nothing
+        {
+            TCPConnection x{TCPConfig{}};
+            x.cork();
+            x.uncork();
+            test_should_be(x.segments_out().size(), size_t{0});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
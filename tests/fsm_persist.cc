@@ -0,0 +1,197 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+constexpr size_t CAPACITY = 4000;
+constexpr size_t RTO = TCPConfig::TIMEOUT_DFLT;
+constexpr size_t RTO_MAX = 4 * RTO;
+
+//! A configuration with a small receive buffer, and a cap on the RTO
+static TCPConfig small_buffer_config() {
+    TCPConfig config;
+    config.recv_capacity = CAPACITY;
+    config.rto_max = RTO_MAX;
+    return config;
+}
+
+//! Tick `x` by one ms short of `ms`, check it sends nothing, then by the last ms and check it sends a probe
+static void expect_probe_after(TCPConnection &x, const size_t ms) {
+    x.tick(ms - 1);
+    test_should_be(x.segments_out().size(), size_t{0});
+    x.tick(1);
+    test_should_be(x.segments_out().size(), size_t{1});
+}
+
+//! Let `x`'s next MAX_RETX_ATTEMPTS probes go unanswered, the first after `ms` and the rest backing off, and check
+//! that it gives up the connection with a RST when the one after is due
+static void expect_abort_after_unanswered(TCPConnection &x, size_t ms) {
+    for (unsigned i = 0; i < TCPConfig::MAX_RETX_ATTEMPTS; i++) {
+        expect_probe_after(x, ms);
+        test_should_be(x.segments_out().front().header().rst, false);
+        x.segments_out().pop();
+        ms = min(2 * ms, RTO_MAX);
+    }
+    test_should_be(x.active(), true);
+    expect_probe_after(x, ms);
+    test_should_be(x.segments_out().front().header().rst, true);
+    test_should_be(x.active(), false);
+}
+
+int main() {
+    try {
+        // probes of a zero window back off exponentially, up to the largest RTO, and while the receiver answers
+        // them, never give up the connection
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            x.write("abc");
+            test_should_be(x.segments_out().size(), size_t{0});
+            expect_probe_after(x, RTO);
+            test_should_be(x.segments_out().front().payload().size(), size_t{1});
+            deliver(x, y);
+            test_should_be(deliver(y, x).value().win, uint16_t{0});
+            test_should_be(x.bytes_in_flight(), size_t{0});
+
+            expect_probe_after(x, 2 * RTO);
+            deliver(x, y);
+            test_should_be(deliver(y, x).value().win, uint16_t{0});
+            for (unsigned i = 0; i < 2 * TCPConfig::MAX_RETX_ATTEMPTS; i++) {
+                expect_probe_after(x, RTO_MAX);
+                deliver(x, y);
+                test_should_be(deliver(y, x).value().win, uint16_t{0});
+            }
+            test_should_be(x.active(), true);
+            test_should_be(x.sender_stats().window_probes, 2 + 2 * TCPConfig::MAX_RETX_ATTEMPTS);
+
+            // once the receiver stops answering, the probes use up the connection's retransmission attempts
+            expect_abort_after_unanswered(x, RTO_MAX);
+        }
+
+        // a receiver that never answers a probe is given up on
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            x.write("abc");
+            expect_abort_after_unanswered(x, RTO);
+        }
+
+        // data in flight when the window shuts is resent on the RTO, which backs off the same way; the resends
+        // the receiver answers don't use up the connection's retransmission attempts
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake(x, y);
+
+            // y takes the first segment and shuts its window (as a receiver that shrinks it may); the rest is lost
+            x.write(string(CAPACITY, 'x'));
+            test_should_be(x.segments_out().size() > 1, true);
+            y.segment_received(take_segment(x));
+            while (not x.segments_out().empty()) {
+                x.segments_out().pop();
+            }
+            TCPSegment answer;
+            answer.header() = deliver(y, x, [](TCPHeader &header) { header.win = 0; }).value();
+            test_should_be(x.bytes_in_flight() > 0, true);
+
+            // y answers each resend with the same zero-window ack (the resends themselves are lost)
+            size_t timeout = RTO;
+            for (unsigned i = 0; i < 2 * TCPConfig::MAX_RETX_ATTEMPTS; i++) {
+                expect_probe_after(x, timeout);
+                test_should_be(x.segments_out().front().header().rst, false);
+                x.segments_out().pop();
+                x.segment_received(answer);
+                timeout = min(2 * timeout, RTO_MAX);
+            }
+            test_should_be(x.active(), true);
+
+            // once the window opens, the resend gets through and the connection carries on
+            y.inbound_stream().pop_output(CAPACITY);
+            y.inbound_read();
+            deliver(y, x);
+            expect_probe_after(x, RTO_MAX);
+            deliver(x, y);
+            test_should_be(y.inbound_stream().buffer_size() > 0, true);
+            test_should_be(x.active(), true);
+        }
+
+        // resends no ack answers use up the connection's retransmission attempts
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake(x, y);
+
+            x.write(string(CAPACITY, 'x'));
+            y.segment_received(take_segment(x));
+            while (not x.segments_out().empty()) {
+                x.segments_out().pop();
+            }
+            deliver(y, x, [](TCPHeader &header) { header.win = 0; });
+            expect_abort_after_unanswered(x, RTO);
+        }
+
+        // a probe the receiver takes counts as sent; the window update that follows sends the rest at once
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            x.write("abc");
+            y.inbound_stream().pop_output(CAPACITY);
+            expect_probe_after(x, RTO);
+            deliver(x, y);
+            test_should_be(y.inbound_stream().read(1) == "a", true);
+            test_should_be(y.segments_out().size(), size_t{1});
+            test_should_be(deliver(y, x).value().win > 0, true);
+
+            test_should_be(x.segments_out().size(), size_t{1});
+            test_should_be(x.segments_out().front().payload().copy() == "bc", true);
+            deliver(x, y);
+            test_should_be(y.inbound_stream().read(2) == "bc", true);
+            test_should_be(x.sender_stats().window_probes, 1u);
+        }
+
+        // a window update stops the timer: the held-back data goes out without a probe
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            x.write("abc");
+            x.tick(RTO - 1);
+            y.inbound_stream().pop_output(CAPACITY);
+            y.inbound_read();
+            deliver(y, x);
+            test_should_be(x.segments_out().size(), size_t{1});
+            test_should_be(x.segments_out().front().payload().size(), size_t{3});
+            x.segments_out().pop();
+            x.tick(1);
+            test_should_be(x.segments_out().size(), size_t{0});
+            test_should_be(x.sender_stats().window_probes, 0u);
+        }
+
+        // with nothing left but the FIN, the probe carries the FIN
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            x.end_input_stream();
+            test_should_be(x.segments_out().size(), size_t{0});
+            expect_probe_after(x, RTO);
+            test_should_be(x.segments_out().front().header().fin, true);
+            test_should_be(x.segments_out().front().payload().size(), size_t{0});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
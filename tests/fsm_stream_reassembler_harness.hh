@@ -19,6 +19,8 @@ class ReassemblerExpectationViolation : public std::runtime_error {
 struct ReassemblerTestStep {
     virtual std::string to_string() const { return "ReassemblerTestStep"; }
     virtual void execute(StreamReassembler &) const {}
+    //! Same as execute(), but submits substrings as Buffers (the path TCPReceiver takes)
+    virtual void execute_with_buffers(StreamReassembler &reassembler) const { execute(reassembler); }
     virtual ~ReassemblerTestStep() {}
 };
 
@@ -157,20 +159,27 @@ struct SubmitSegment : public ReassemblerAction {
     }
 
     void execute(StreamReassembler &reassembler) const { reassembler.push_substring(_data, _index, _eof); }
+
+    void execute_with_buffers(StreamReassembler &reassembler) const {
+        reassembler.push_substring(Buffer{std::string{_data}}, _index, _eof);
+    }
 };
 
 class ReassemblerTestHarness {
     StreamReassembler reassembler;
+    StreamReassembler buffer_reassembler;  //!< Gets the same steps, with substrings submitted as Buffers
     std::vector<std::string> steps_executed;
 
   public:
-    ReassemblerTestHarness(const size_t capacity) : reassembler(capacity), steps_executed() {
+    ReassemblerTestHarness(const size_t capacity)
+        : reassembler(capacity), buffer_reassembler(capacity), steps_executed() {
         steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) + ")");
     }
 
     void execute(const ReassemblerTestStep &step) {
         try {
             step.execute(reassembler);
+            step.execute_with_buffers(buffer_reassembler);
             steps_executed.emplace_back(step.to_string());
         } catch (const ReassemblerExpectationViolation &e) {
             std::cerr << "Test Failure on expectation:\n\t" << step.to_string();
@@ -0,0 +1,116 @@
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! Check that `header` carries the timestamps `tsval` and `tsecr`
+static void check_timestamps(const TCPHeader &header, const uint32_t tsval, const uint32_t tsecr) {
+    test_should_be(header.has_timestamps, true);
+    test_should_be(header.tsval, tsval);
+    test_should_be(header.tsecr, tsecr);
+}
+
+int main() {
+    try {
+        // the option survives serialization, and leaves room for three SACK blocks
+        {
+            TCPHeader header;
+            header.has_timestamps = true;
+            header.tsval = 123456789;
+            header.tsecr = 987654321;
+            header.num_sack_blocks = TCPHeader::MAX_SACK_BLOCKS;
+            test_should_be(header.length(), TCPHeader::MAX_LENGTH);
+
+            TCPHeader parsed;
+            NetParser parser{header.serialize()};
+            if (parsed.parse(parser) != ParseResult::NoError) {
+                throw runtime_error("failed to parse a serialized header");
+            }
+            check_timestamps(parsed, 123456789, 987654321);
+            test_should_be(parsed.num_sack_blocks, uint8_t{3});
+        }
+
+        // both SYNs carry the option, each echoing the other's clock; then so does every segment
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            x.tick(5);
+            y.tick(70);
+            x.connect();
+            check_timestamps(deliver(x, y).value(), 5, 0);
+            check_timestamps(deliver(y, x).value(), 70, 5);
+
+            x.tick(10);
+            x.write("hello");
+            check_timestamps(deliver(x, y).value(), 15, 70);
+            check_timestamps(deliver(y, x).value(), 70, 15);
+        }
+
+        // a resent segment is timed by the timestamp its ack echoes, where Karn's algorithm would give nothing
+        for (const bool timestamps : {true, false}) {
+            TCPConfig config;
+            config.timestamps = timestamps;
+            TCPConnection x{config}, y{config};
+            handshake(x, y);
+            const auto samples = x.sender_stats().rtt_samples;
+
+            x.write("hello");
+            x.segments_out().pop();  // lost
+            x.tick(TCPConfig::TIMEOUT_DFLT);
+            test_should_be(x.segments_out().size(), size_t{1});
+            deliver(x, y);
+            x.tick(30);
+            deliver(y, x);
+
+            test_should_be(x.sender_stats().rtt_samples, samples + (timestamps ? 1 : 0));
+            if (timestamps) {
+                test_should_be(x.sender_stats().latest_rtt.value(), uint64_t{30});
+            }
+        }
+
+        // a segment with a timestamp older than the last taken is dropped (PAWS), and acknowledged
+        {
+            TCPConnection x{TCPConfig{}}, y{TCPConfig{}};
+            handshake(x, y);
+
+            x.tick(10);
+            x.write("abc");
+            const TCPSegment abc = take_segment(x);
+            y.segment_received(abc);
+            x.tick(10);
+            x.write("def");
+            deliver(x, y);
+            deliver(y, x);
+            test_should_be(y.inbound_stream().buffer_size(), size_t{6});
+
+            // a segment from long ago, once the sequence numbers have wrapped around to the next bytes
+            TCPSegment old_duplicate = abc;
+            old_duplicate.header().seqno = abc.header().seqno + 6;
+            old_duplicate.payload() = Buffer{string("ghi")};
+            y.segment_received(old_duplicate);
+            test_should_be(y.inbound_stream().buffer_size(), size_t{6});
+            test_should_be(take_segment(y).header().ackno, old_duplicate.header().seqno);
+
+            // the same segment, sent since
+            old_duplicate.header().tsval = 20;
+            y.segment_received(old_duplicate);
+            test_should_be(y.inbound_stream().buffer_size(), size_t{9});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+constexpr size_t CAPACITY = 4'000'000;
+
+//! A configuration with multi-megabyte buffers, and a congestion window that doesn't limit the sender
+static TCPConfig big_config() {
+    TCPConfig config;
+    config.recv_capacity = config.send_capacity = CAPACITY;
+    config.initial_cwnd = CAPACITY;
+    return config;
+}
+
+int main() {
+    try {
+        // the option survives serialization, beside SACK-permitted
+        {
+            TCPHeader header;
+            header.syn = true;
+            header.window_scale = 7;
+            header.sack_permitted = true;
+            test_should_be(header.length(), TCPHeader::LENGTH + 8);
+
+            TCPHeader parsed;
+            NetParser parser{header.serialize()};
+            if (parsed.parse(parser) != ParseResult::NoError) {
+                throw runtime_error("failed to parse a serialized header");
+            }
+            test_should_be(parsed.window_scale.value(), uint8_t{7});
+            test_should_be(parsed.sack_permitted, true);
+        }
+
+        // both SYNs carry the option; after them the receiver's window is advertised scaled, and the
+        // sender can fill it: once the first round trip has brought a scaled window, the rest of the
+        // multi-megabyte buffer goes out in one flight
+        {
+            TCPConnection x{big_config()}, y{big_config()};
+            x.connect();
+            const auto syn = deliver(x, y);
+            test_should_be(syn.value().window_scale.value(), uint8_t{6});  // 4,000,000 >> 6 fits in 16 bits
+            test_should_be(syn.value().win, uint16_t{65535});              // but the SYN's window isn't scaled
+            const auto syn_ack = deliver(y, x);
+            test_should_be(syn_ack.value().window_scale.value(), uint8_t{6});
+            deliver(x, y);
+
+            test_should_be(x.write(string(CAPACITY, 'x')), CAPACITY);
+            test_should_be(x.bytes_in_flight(), size_t{65535});  // as much as the SYN's window allows
+            deliver(x, y);
+            deliver(y, x);
+            test_should_be(x.bytes_in_flight(), CAPACITY - 65535);
+            deliver(x, y);
+            test_should_be(y.inbound_stream().buffer_size(), CAPACITY);
+
+            // the ack advertises what's left of the window, in units of 64 bytes
+            test_should_be(deliver(y, x).value().win, uint16_t{0});
+            y.inbound_stream().pop_output(1000);
+            y.end_input_stream();
+            test_should_be(deliver(y, x).value().win, uint16_t{1000 / 64});
+        }
+
+        // a peer that doesn't offer the option gets no scaled windows, and can send no more than 64 KiB
+        {
+            TCPConfig unscaled = big_config();
+            unscaled.window_scaling = false;
+            TCPConnection x{unscaled}, y{big_config()};
+            x.connect();
+            test_should_be(deliver(x, y).value().window_scale.has_value(), false);
+            test_should_be(deliver(y, x).value().window_scale.has_value(), false);
+            deliver(x, y);
+
+            x.write(string(CAPACITY, 'x'));
+            for (unsigned round_trip = 0; round_trip < 2; round_trip++) {
+                test_should_be(x.bytes_in_flight(), size_t{65535});
+                deliver(x, y);
+                y.inbound_stream().pop_output(y.inbound_stream().buffer_size());
+                deliver(y, x);
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
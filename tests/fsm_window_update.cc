@@ -0,0 +1,103 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+constexpr size_t CAPACITY = 4000;
+
+//! A configuration with a small receive buffer, and segments a quarter its size
+static TCPConfig small_buffer_config() {
+    TCPConfig config;
+    config.recv_capacity = CAPACITY;
+    config.mss = CAPACITY / 4;
+    return config;
+}
+
+int main() {
+    try {
+        const size_t MSS = CAPACITY / 4;
+
+        // a window opened by less than an MSS isn't advertised, even on an ack; a full MSS is, at once
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            y.inbound_stream().pop_output(MSS - 1);
+            y.inbound_read();
+            test_should_be(y.segments_out().size(), size_t{0});
+            x.write("a");
+            test_should_be(x.segments_out().size(), size_t{0});
+            x.tick(TCPConfig::TIMEOUT_DFLT);
+            deliver(x, y);  // x probes the zero window, and the probe's byte takes up some of the room
+            test_should_be(deliver(y, x).value().win, uint16_t{0});
+
+            y.inbound_stream().pop_output(2);
+            y.inbound_read();
+            test_should_be(deliver(y, x).value().win, uint16_t{MSS});
+        }
+
+        // reads the owner doesn't report are advertised at the next tick
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            y.inbound_stream().pop_output(2 * MSS);
+            test_should_be(y.segments_out().size(), size_t{0});
+            y.tick(1);
+            test_should_be(deliver(y, x).value().win, uint16_t{2 * MSS});
+        }
+
+        // once advertised, the window's right edge holds still until it can move by an MSS; an update is
+        // sent only once the window has doubled
+        {
+            TCPConnection x{small_buffer_config()}, y{small_buffer_config()};
+            handshake_and_fill(x, y, CAPACITY);
+
+            y.inbound_stream().pop_output(MSS);
+            y.inbound_read();
+            test_should_be(deliver(y, x).value().win, uint16_t{MSS});
+
+            x.write(string(MSS / 2, 'x'));
+            deliver(x, y);
+            test_should_be(deliver(y, x).value().win, uint16_t{MSS / 2});
+            y.inbound_stream().pop_output(MSS / 2);
+            y.inbound_read();
+            test_should_be(y.segments_out().size(), size_t{0});
+            x.write(string(MSS / 2, 'x'));
+            deliver(x, y);
+            test_should_be(deliver(y, x).value().win, uint16_t{0});  // the edge stayed put
+
+            y.inbound_stream().pop_output(MSS / 2);
+            y.inbound_read();
+            test_should_be(deliver(y, x).value().win, uint16_t{MSS});
+        }
+
+        // a buffer smaller than two segments opens in steps of half its size
+        {
+            TCPConfig config = small_buffer_config();
+            config.mss = CAPACITY;
+            TCPConnection x{config}, y{config};
+            handshake_and_fill(x, y, CAPACITY);
+
+            y.inbound_stream().pop_output(CAPACITY / 2 - 1);
+            y.inbound_read();
+            test_should_be(y.segments_out().size(), size_t{0});
+            y.inbound_stream().pop_output(1);
+            y.inbound_read();
+            test_should_be(deliver(y, x).value().win, uint16_t{CAPACITY / 2});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -233,7 +233,7 @@ int main(int argc, char **argv) {
                 ipv4_hdr_copy.len -= 4 * ipv4_hdr_orig.hlen - IPv4Header::LENGTH;
                 ipv4_hdr_copy.hlen = 5;
                 ipv4_hdr_copy.len -= 4 * tcp_hdr_orig.doff - TCPHeader::LENGTH;
-                tcp_hdr_copy.doff = 5;
+                strip_tcp_options(tcp_hdr_copy);
             }  // ipv4_hdr_{orig,copy}, tcp_hdr_{orig,copy} go out of scope
 
             if (!compare_ip_headers_nolen(ip_dgram.header(), ip_dgram_copy.header())) {
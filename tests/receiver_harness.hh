@@ -13,6 +13,8 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 struct ReceiverTestStep {
     virtual std::string to_string() const { return "ReceiverTestStep"; }
@@ -100,6 +102,33 @@ struct ExpectUnassembledBytes : public ReceiverExpectation {
     }
 };
 
+struct ExpectSackBlocks : public ReceiverExpectation {
+    std::vector<std::pair<uint32_t, uint32_t>> _blocks;
+
+    ExpectSackBlocks(std::vector<std::pair<uint32_t, uint32_t>> blocks) : _blocks(std::move(blocks)) {}
+
+    static std::string to_string(const std::vector<std::pair<uint32_t, uint32_t>> &blocks) {
+        std::ostringstream ss;
+        for (const auto &[left, right] : blocks) {
+            ss << "[" << left << ", " << right << ")";
+        }
+        return blocks.empty() ? "none" : ss.str();
+    }
+
+    std::string description() const { return "SACK blocks " + to_string(_blocks); }
+
+    void execute(TCPReceiver &receiver) const {
+        std::vector<std::pair<uint32_t, uint32_t>> reported;
+        for (const auto &block : receiver.sack_blocks()) {
+            reported.emplace_back(block.left.raw_value(), block.right.raw_value());
+        }
+        if (reported != _blocks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported SACK blocks " + to_string(reported) +
+                                               ", but they were expected to be " + to_string(_blocks));
+        }
+    }
+};
+
 struct ExpectTotalAssembledBytes : public ReceiverExpectation {
     size_t _n_bytes;
 
@@ -0,0 +1,101 @@
+#include "receiver_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // No blocks before the SYN, or while everything is in order
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{}});
+        }
+
+        // One out-of-order segment, then the hole is filled
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{{isn + 5, isn + 9}}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(ExpectBytes{"abcdefgh"});
+        }
+
+        // Adjacent and overlapping segments are reported as one block
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 11).with_data("klmn").with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 7).with_data("ghij").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{{isn + 7, isn + 15}}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 13).with_data("mnop").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{{isn + 7, isn + 17}}});
+        }
+
+        // Several holes: blocks are listed in sequence order, and filling the first hole drops its block
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 21).with_data("uv").with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 3).with_data("cd").with_result(SegmentArrives::Result::OK));
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 11).with_data("kl").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{{isn + 3, isn + 5}, {isn + 11, isn + 13}, {isn + 21, isn + 23}}});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 1).with_data("ab").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{{isn + 11, isn + 13}, {isn + 21, isn + 23}}});
+            test.execute(ExpectBytes{"abcd"});
+        }
+
+        // More ranges than fit in the option: the ones with the most recent data are reported
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            for (const uint32_t offset : {10, 30, 50, 70, 90, 110}) {
+                test.execute(
+                    SegmentArrives{}.with_seqno(isn + offset).with_data("xy").with_result(SegmentArrives::Result::OK));
+            }
+            test.execute(ExpectSackBlocks{{{isn + 50, isn + 52}, {isn + 70, isn + 72}, {isn + 90, isn + 92},
+                                           {isn + 110, isn + 112}}});
+
+            // new data extending an old range brings it back into the report
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 12).with_data("zz").with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSackBlocks{{{isn + 10, isn + 14}, {isn + 70, isn + 72}, {isn + 90, isn + 92},
+                                           {isn + 110, isn + 112}}});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
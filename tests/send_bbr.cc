@@ -0,0 +1,233 @@
+#include "bbr_controller.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+//! Fail unless BBR is in `expected`
+static void expect_state(const BbrController &bbr, const BbrController::State expected) {
+    static constexpr const char *names[] = {"STARTUP", "DRAIN", "PROBE_BW", "PROBE_RTT"};
+    if (bbr.state() != expected) {
+        throw runtime_error(string{"BBR should have been in "} + names[static_cast<int>(expected)] + ", but was in " +
+                            names[static_cast<int>(bbr.state())]);
+    }
+}
+
+//! A path the test delivers data over, one acknowledgment per round trip
+struct Path {
+    uint64_t now = 0;        //!< the sender's clock
+    uint64_t delivered = 0;  //!< bytes delivered so far
+};
+
+//! Deliver a round trip's worth of data at `rate` bytes per ms, leaving `pipe` bytes in the network
+static void round_trip(BbrController &bbr, Path &path, const double rate, const uint64_t rtt, const size_t pipe) {
+    const uint64_t prior_delivered = path.delivered;
+    const uint64_t bytes = static_cast<uint64_t>(rate * rtt);
+    path.now += rtt;
+    path.delivered += bytes;
+
+    AckEvent ack;
+    ack.now = path.now;
+    ack.ackno = path.delivered;
+    ack.next_seqno = path.delivered + pipe;
+    ack.newly_acked = bytes;
+    ack.bytes_in_flight = pipe;
+    ack.rtt = rtt;
+    ack.delivered = path.delivered;
+    ack.sample = RateSample{prior_delivered, bytes, rtt, false};
+    ack.pipe = pipe;
+    bbr.on_ack(ack);
+}
+
+//! Take BBR through STARTUP and DRAIN on a 40 bytes/ms, 100 ms path, into PROBE_BW
+static void fill_pipe(BbrController &bbr, Path &path) {
+    for (const double rate : {10.0, 20.0, 40.0, 40.0, 40.0, 40.0}) {
+        round_trip(bbr, path, rate, 100, 8000);
+    }
+    round_trip(bbr, path, 40, 100, 4000);
+}
+
+int main() {
+    try {
+        // the configuration selects BBR
+        {
+            TCPConfig cfg;
+            cfg.congestion_control = TCPConfig::CongestionControl::Bbr;
+            const auto controller = CongestionController::make(cfg);
+            if (dynamic_cast<const BbrController *>(controller.get()) == nullptr) {
+                throw runtime_error("TCPConfig::CongestionControl::Bbr didn't make a BbrController");
+            }
+        }
+
+        // the windowed max filter keeps the best sample until it ages out of the window
+        {
+            WindowedMaxFilter filter{10};
+            filter.update(0, 50);
+            filter.update(3, 30);
+            filter.update(6, 20);
+            test_should_be(filter.get(), 50.0);
+            filter.update(11, 10);
+            test_should_be(filter.get(), 30.0);
+            filter.update(30, 5);
+            test_should_be(filter.get(), 5.0);
+        }
+
+        // STARTUP runs until the bandwidth stops growing for three rounds, then DRAIN empties the queue
+        {
+            BbrController bbr{MSS, 10 * MSS};
+            Path path;
+            expect_state(bbr, BbrController::State::Startup);
+            test_should_be(bbr.pacing_rate().has_value(), false);
+
+            for (const double rate : {10.0, 20.0, 40.0, 40.0, 40.0}) {
+                round_trip(bbr, path, rate, 100, 8000);
+                expect_state(bbr, BbrController::State::Startup);
+            }
+            test_should_be(bbr.bottleneck_bandwidth(), 40.0);
+            test_should_be(bbr.min_rtt().value(), uint64_t{100});
+            test_should_be(bbr.pacing_rate().value(), BbrController::HIGH_GAIN * 40);
+
+            round_trip(bbr, path, 40, 100, 8000);
+            expect_state(bbr, BbrController::State::Drain);
+            test_should_be(bbr.pacing_rate().value(), BbrController::DRAIN_GAIN * 40);
+
+            // the queue is gone once no more than a BDP (4000 bytes) is in flight
+            round_trip(bbr, path, 40, 100, 4000);
+            expect_state(bbr, BbrController::State::ProbeBw);
+        }
+
+        // PROBE_BW caps the window at twice the BDP (plus room for delayed acks), and cycles its pacing gain
+        {
+            BbrController bbr{MSS, 10 * MSS};
+            Path path;
+            fill_pipe(bbr, path);
+            bool probed = false, drained = false;
+            for (unsigned i = 0; i < 2 * BbrController::GAIN_CYCLE_LENGTH; i++) {
+                // each phase lasts longer than RTprop, and probing needs 1.25 BDPs in flight
+                round_trip(bbr, path, 40, 110, 5000);
+                test_should_be(bbr.cwnd(), 2 * 4000 + 3 * MSS);
+                test_should_be(bbr.pacing_rate().value(), bbr.pacing_gain() * 40);
+                probed |= bbr.pacing_gain() > 1;
+                drained |= bbr.pacing_gain() < 1;
+            }
+            if (not probed or not drained) {
+                throw runtime_error("PROBE_BW didn't cycle its pacing gain");
+            }
+        }
+
+        // loss doesn't shrink the model: the window drops to what's still in flight, and the pacing rate holds
+        {
+            BbrController bbr{MSS, 10 * MSS};
+            Path path;
+            fill_pipe(bbr, path);
+            round_trip(bbr, path, 40, 100, 4000);
+            const size_t cwnd = bbr.cwnd();
+            const double pacing_rate = bbr.pacing_rate().value();
+
+            bbr.on_loss(path.now, 8000, path.delivered + 8000, 2 * MSS);
+            test_should_be(bbr.cwnd(), BbrController::MIN_PIPE_SEGMENTS * MSS);
+            test_should_be(bbr.bottleneck_bandwidth(), 40.0);
+            test_should_be(bbr.pacing_rate().value(), pacing_rate);
+
+            // the window grows with what's delivered, and is restored once recovery is over
+            round_trip(bbr, path, 40, 100, 4000);
+            test_should_be(bbr.cwnd(), 2 * BbrController::MIN_PIPE_SEGMENTS * MSS);
+            round_trip(bbr, path, 40, 100, 4000);
+            test_should_be(bbr.cwnd(), cwnd);
+        }
+
+        // a timeout leaves the model alone too; the window returns once what was resent is delivered
+        {
+            BbrController bbr{MSS, 10 * MSS};
+            Path path;
+            fill_pipe(bbr, path);
+            round_trip(bbr, path, 40, 100, 4000);
+            const size_t cwnd = bbr.cwnd();
+
+            bbr.on_rto(path.now + 1000, 4000);
+            test_should_be(bbr.cwnd(), MSS);
+            test_should_be(bbr.bottleneck_bandwidth(), 40.0);
+            path.now += 1000;
+            round_trip(bbr, path, 10, 100, 4000);
+            test_should_be(bbr.cwnd(), cwnd);
+        }
+
+        // with no RTT as low as RTprop for 10 s, PROBE_RTT drains the pipe to four segments to measure it again
+        {
+            BbrController bbr{MSS, 10 * MSS};
+            Path path;
+            fill_pipe(bbr, path);
+            const uint64_t probe_rtt_start = path.now + BbrController::MIN_RTT_FILTER_MS;
+            while (path.now + 120 <= probe_rtt_start) {
+                round_trip(bbr, path, 40, 120, 4000);
+                expect_state(bbr, BbrController::State::ProbeBw);
+            }
+            round_trip(bbr, path, 40, 120, 5000);
+            expect_state(bbr, BbrController::State::ProbeRtt);
+            test_should_be(bbr.cwnd(), BbrController::MIN_PIPE_SEGMENTS * MSS);
+            test_should_be(bbr.min_rtt().value(), uint64_t{120});
+
+            // it stays for at least PROBE_RTT_MS and a round once the pipe has drained...
+            round_trip(bbr, path, 40, 120, BbrController::MIN_PIPE_SEGMENTS * MSS);
+            round_trip(bbr, path, 40, 120, BbrController::MIN_PIPE_SEGMENTS * MSS);
+            expect_state(bbr, BbrController::State::ProbeRtt);
+
+            // ...then goes back to PROBE_BW with its window
+            round_trip(bbr, path, 40, 120, BbrController::MIN_PIPE_SEGMENTS * MSS);
+            expect_state(bbr, BbrController::State::ProbeBw);
+            if (bbr.cwnd() <= BbrController::MIN_PIPE_SEGMENTS * MSS) {
+                throw runtime_error("PROBE_RTT didn't restore the window");
+            }
+        }
+
+        // the sender samples the delivery rate over the time from sending a segment to its acknowledgment...
+        {
+            TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN, make_unique<BbrController>(MSS, 10 * MSS)};
+            const auto &bbr = dynamic_cast<const BbrController &>(sender.congestion_controller());
+            connect(sender, 10, 100);
+            test_should_be(sender.bytes_in_flight(), 10 * MSS);
+            test_should_be(bbr.min_rtt().value(), uint64_t{100});
+
+            sender.tick(100);
+            sender.ack_received(ISN + 1 + 10 * MSS, 60000);
+            test_should_be(bbr.bottleneck_bandwidth(), 10.0 * MSS / 100);
+        }
+
+        // ...and SACKed data counts as delivered
+        {
+            TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN, make_unique<BbrController>(MSS, 10 * MSS)};
+            const auto &bbr = dynamic_cast<const BbrController &>(sender.congestion_controller());
+            connect(sender, 10, 100);
+            test_should_be(sender.bytes_in_flight(), 10 * MSS);
+
+            sender.tick(100);
+            TCPSegment segment;
+            TCPHeader &header = segment.header();
+            header.ack = true;
+            header.ackno = ISN + 1;
+            header.win = 60000;
+            header.num_sack_blocks = 1;
+            header.sack_blocks[0] = {ISN + 1 + MSS, ISN + 1 + 10 * MSS};
+            sender.ack_received(segment);
+            test_should_be(bbr.bottleneck_bandwidth(), 9.0 * MSS / 100);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.initial_cwnd = 3 * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"Initial congestion window is respected", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{3000});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.initial_cwnd = 3 * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"Slow start opens the window by a segment per acknowledged segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 3001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{4000});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.initial_cwnd = 3 * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"A timeout collapses the window to one segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(10000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+
+            // slow start up to ssthresh (half the flight size, but two segments at least)...
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+
+            // ...then congestion avoidance: a segment per window's worth of acknowledged bytes
+            test.execute(AckReceived{WrappingInt32{isn + 3001}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 3001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 5001));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.initial_cwnd = 3 * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"The receiver's window still applies when it is smaller", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1500));
+            test.execute(WriteBytes{string(10000, 'a')});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
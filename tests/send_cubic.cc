@@ -0,0 +1,176 @@
+#include "cubic_controller.hh"
+#include "tcp_config.hh"
+#include "test_should_be.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+//! Acknowledge `segments` segments, one ack each, `rtt` ms after they were sent; the sender
+//! keeps the window full
+static void ack_segments(CubicController &cubic,
+                         const uint64_t now,
+                         uint64_t &ackno,
+                         const size_t segments,
+                         const uint64_t rtt) {
+    for (size_t i = 0; i < segments; i++) {
+        const uint64_t next_seqno = ackno + cubic.cwnd();
+        ackno += MSS;
+        cubic.on_ack({now, ackno, next_seqno, MSS, next_seqno - ackno, rtt});
+    }
+}
+
+int main() {
+    try {
+        // the configuration selects CUBIC
+        {
+            TCPConfig cfg;
+            cfg.congestion_control = TCPConfig::CongestionControl::Cubic;
+            const auto controller = CongestionController::make(cfg);
+            if (dynamic_cast<const CubicController *>(controller.get()) == nullptr) {
+                throw runtime_error("TCPConfig::CongestionControl::Cubic didn't make a CubicController");
+            }
+        }
+
+        // a loss keeps 70% of the window, and remembers the window given up as W_max
+        {
+            CubicController cubic{MSS, 10 * MSS};
+            cubic.on_loss(0, 10 * MSS, 20 * MSS, 9 * MSS);
+            test_should_be(cubic.cwnd(), 7 * MSS);
+            test_should_be(cubic.ssthresh(), 7 * MSS);
+            test_should_be(cubic.w_max(), 10 * MSS);
+
+            // no growth until the recovery point is acknowledged
+            cubic.on_ack({100, 15 * MSS, 20 * MSS, 5 * MSS, 15 * MSS, 100});
+            test_should_be(cubic.cwnd(), 7 * MSS);
+            cubic.on_ack({200, 20 * MSS, 27 * MSS, 5 * MSS, 7 * MSS, 100});
+            test_should_be(cubic.cwnd(), 7 * MSS);
+            test_should_be(cubic.epoch_start().has_value(), false);
+
+            // a second loss below W_max releases more of it (fast convergence)
+            cubic.on_loss(300, 7 * MSS, 27 * MSS, 6 * MSS);
+            test_should_be(cubic.w_max(), static_cast<size_t>(7 * (1 + CubicController::BETA) / 2 * MSS));
+        }
+
+        // the window is reduced from what was in flight when the receiver kept cwnd from filling
+        {
+            CubicController cubic{MSS, 40 * MSS};
+            cubic.on_loss(0, 10 * MSS, 10 * MSS, 9 * MSS);
+            test_should_be(cubic.cwnd(), 7 * MSS);
+            test_should_be(cubic.w_max(), 10 * MSS);
+        }
+
+        // on a long path, the window regains W_max in about K seconds, however many round trips that is...
+        {
+            CubicController cubic{MSS, 100 * MSS};
+            cubic.on_loss(0, 100 * MSS, 100 * MSS, 99 * MSS);
+            uint64_t now = 0, ackno = 100 * MSS;
+            ack_segments(cubic, now, ackno, 1, 500);  // ends recovery
+            now += 500;
+            ack_segments(cubic, now, ackno, 1, 500);
+            const uint64_t epoch = now;
+            test_should_be(cubic.epoch_start().value(), epoch);
+
+            // the window aims a round trip ahead, so it reaches W_max a round trip before K
+            const double k = cbrt(100 * (1 - CubicController::BETA) / CubicController::C);
+            const uint64_t k_ms = static_cast<uint64_t>(1000 * k);
+            while (now + 500 + 500 < epoch + k_ms) {
+                now += 500;
+                ack_segments(cubic, now, ackno, cubic.cwnd() / MSS, 500);
+                if (cubic.cwnd() > 100 * MSS) {
+                    throw runtime_error("CUBIC passed W_max before K");
+                }
+            }
+            if (cubic.cwnd() < 95 * MSS) {
+                throw runtime_error("CUBIC didn't approach W_max by K");
+            }
+
+            // ...and then probes beyond it
+            for (unsigned i = 0; i < 4; i++) {
+                now += 500;
+                ack_segments(cubic, now, ackno, cubic.cwnd() / MSS, 500);
+            }
+            if (cubic.cwnd() < 101 * MSS) {
+                throw runtime_error("CUBIC didn't probe beyond W_max");
+            }
+        }
+
+        // on a short path, the window grows at least as fast as standard TCP's would (the TCP-friendly region)
+        {
+            CubicController cubic{MSS, 10 * MSS};
+            cubic.on_loss(0, 10 * MSS, 10 * MSS, 9 * MSS);
+            uint64_t now = 0, ackno = 10 * MSS;
+            ack_segments(cubic, now, ackno, 1, 1);  // ends recovery
+            for (unsigned rtt = 0; rtt < 100; rtt++) {
+                now++;
+                ack_segments(cubic, now, ackno, cubic.cwnd() / MSS, 1);
+            }
+            // 100 round trips at ALPHA segments each, where the cubic function alone would still be short of W_max
+            if (cubic.cwnd() < 50 * MSS) {
+                throw runtime_error("CUBIC grew slower than standard TCP");
+            }
+        }
+
+        // a timeout collapses the window to one segment, and slow start resumes up to 70% of the flight size
+        {
+            CubicController cubic{MSS, 10 * MSS};
+            cubic.on_rto(1000, 10 * MSS);
+            test_should_be(cubic.cwnd(), MSS);
+            test_should_be(cubic.ssthresh(), 7 * MSS);
+            cubic.on_rto(3000, 10 * MSS);
+            test_should_be(cubic.ssthresh(), 7 * MSS);
+            uint64_t ackno = 0;
+            ack_segments(cubic, 3000, ackno, 6, 100);
+            test_should_be(cubic.cwnd(), 7 * MSS);
+        }
+
+        // HyStart: slow start continues while the round trip time holds steady...
+        {
+            CubicController cubic{MSS, 10 * MSS};
+            uint64_t ackno = 0;
+            ack_segments(cubic, 0, ackno, 10, 100);
+            ack_segments(cubic, 100, ackno, 20, 101);
+            ack_segments(cubic, 200, ackno, 40, 102);
+            test_should_be(cubic.cwnd(), 80 * MSS);
+            test_should_be(cubic.ssthresh(), numeric_limits<size_t>::max());
+        }
+
+        // ...and ends once a whole round's samples show a queue building
+        {
+            CubicController cubic{MSS, 10 * MSS};
+            uint64_t ackno = 0;
+            ack_segments(cubic, 0, ackno, 10, 100);
+            ack_segments(cubic, 100, ackno, CubicController::HYSTART_MIN_SAMPLES, 100 + 12);
+            const size_t cwnd = cubic.cwnd();
+            test_should_be(cubic.ssthresh(), cwnd);
+            ack_segments(cubic, 200, ackno, 10, 100);
+            if (cubic.cwnd() >= cwnd + 10 * MSS) {
+                throw runtime_error("CUBIC stayed in slow start after HyStart's exit");
+            }
+        }
+
+        // ...but not while the window is below HyStart's low window
+        {
+            CubicController cubic{MSS, 2 * MSS};
+            cubic.on_ack({0, MSS, 2 * MSS, MSS, MSS, 100});
+            for (uint64_t ackno = 3 * MSS; cubic.cwnd() < CubicController::HYSTART_LOW_WINDOW * MSS; ackno += MSS) {
+                test_should_be(cubic.ssthresh(), numeric_limits<size_t>::max());
+                cubic.on_ack({100, ackno, 100 * MSS, MSS, 100 * MSS - ackno, 100 + 50});
+            }
+            test_should_be(cubic.ssthresh(), CubicController::HYSTART_LOW_WINDOW * MSS);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+#include "congestion_control.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+//! A sender limited to four segments in flight, with its SYN acknowledged and ten segments' worth to send
+static TCPSender connected_sender() {
+    TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN, make_unique<NewRenoController>(MSS, 4 * MSS)};
+    connect(sender, 10);
+    return sender;
+}
+
+int main() {
+    try {
+        // the first two duplicate acks each send a new segment (limited transmit); the third resends
+        // the oldest, and fast recovery sends new data as further duplicate acks show room in the pipe
+        {
+            TCPSender sender = connected_sender();
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+
+            sender.ack_received(ack(1));
+            sender.fill_window();
+            expect_sent(sender, {1 + 4 * MSS});
+            sender.ack_received(ack(1));
+            sender.fill_window();
+            expect_sent(sender, {1 + 5 * MSS});
+
+            sender.ack_received(ack(1));
+            sender.fill_window();
+            expect_sent(sender, {1});
+            test_should_be(sender.congestion_controller().cwnd(), 3 * MSS);
+
+            sender.ack_received(ack(1));
+            sender.fill_window();
+            expect_sent(sender, {1 + 6 * MSS});
+
+            // a partial ack resends the next hole at once
+            sender.ack_received(ack(1 + 2 * MSS));
+            sender.fill_window();
+            expect_sent(sender, {1 + 2 * MSS, 1 + 7 * MSS});
+
+            // the full ack ends recovery, with the window at ssthresh
+            sender.ack_received(ack(1 + 8 * MSS));
+            sender.fill_window();
+            expect_sent(sender, {1 + 8 * MSS, 1 + 9 * MSS});
+            test_should_be(sender.congestion_controller().cwnd(), 3 * MSS);
+            test_should_be(sender.consecutive_retransmissions(), 0u);
+        }
+
+        // reordering by less than three segments isn't taken for loss
+        {
+            TCPSender sender = connected_sender();
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+            for (unsigned i = 0; i < 2; i++) {
+                sender.ack_received(ack(1));
+                sender.ack_received(ack(1));
+                sender.ack_received(ack(1 + 2 * MSS * (i + 1)));
+                sender.fill_window();
+            }
+            expect_sent(sender, {1 + 4 * MSS, 1 + 5 * MSS, 1 + 6 * MSS, 1 + 7 * MSS, 1 + 8 * MSS, 1 + 9 * MSS});
+            test_should_be(sender.congestion_controller().cwnd(), 6 * MSS);
+        }
+
+        // an ack on a segment that carries data, or one whose segment isn't known, isn't a duplicate
+        {
+            TCPSender sender = connected_sender();
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+            TCPSegment with_data = ack(1);
+            with_data.payload() = Buffer{"data"};
+            for (unsigned i = 0; i < 3; i++) {
+                sender.ack_received(with_data);
+                sender.ack_received(ISN + 1, 60000);
+            }
+            sender.fill_window();
+            expect_sent(sender, {});
+        }
+
+        // nor is one that changes the window
+        {
+            TCPSender sender = connected_sender();
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+            for (uint16_t win = 50000; win < 50003; win++) {
+                TCPSegment window_update = ack(1);
+                window_update.header().win = win;
+                sender.ack_received(window_update);
+            }
+            sender.fill_window();
+            expect_sent(sender, {});
+        }
+
+        // after a timeout, duplicate acks don't begin fast retransmit until recovery from it is over
+        {
+            TCPSender sender = connected_sender();
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+            sender.tick(1000);
+            expect_sent(sender, {1});
+            for (unsigned i = 0; i < 3; i++) {
+                sender.ack_received(ack(1));
+            }
+            sender.fill_window();
+            expect_sent(sender, {});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -67,6 +67,8 @@ int main() {
             const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
             cfg.fixed_isn = isn;
             cfg.rt_timeout = rto;
+            // hold the RTO at rt_timeout: the round trip sampled below would otherwise raise it
+            cfg.rto_max = rto;
 
             TCPSenderTestHarness test{"Timer restarts on ACK of new data", cfg};
 
@@ -204,6 +206,8 @@ int main() {
             const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
             cfg.fixed_isn = isn;
             cfg.rt_timeout = rto;
+            // hold the RTO at rt_timeout: the round trip sampled below would otherwise raise it
+            cfg.rto_max = rto;
 
             TCPSenderTestHarness test{"Retransmit a FIN-only segment same as any other", cfg};
             test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
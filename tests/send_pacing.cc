@@ -0,0 +1,120 @@
+#include "pacer.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+
+using namespace std;
+
+constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+//! A sender paced at `rate` with a two-segment burst, its SYN acknowledged and ten segments' worth to send
+static TCPSender connected_sender(const optional<double> rate) {
+    TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN};
+    sender.enable_pacing(rate, 2 * MSS);
+    connect(sender, 10, 100);
+    return sender;
+}
+
+//! \returns how many segments the sender has sent, dequeuing them
+static size_t segments_sent(TCPSender &sender) {
+    size_t count = 0;
+    while (not sender.segments_out().empty()) {
+        sender.segments_out().pop();
+        count++;
+    }
+    return count;
+}
+
+int main() {
+    try {
+        // the bucket holds the burst allowance; a segment may overdraw it, and the debt is repaid at the rate
+        {
+            Pacer pacer{2000};
+            pacer.refill(0, 100.0);
+            test_should_be(pacer.may_send(), true);
+            pacer.consume(1500);
+            test_should_be(pacer.may_send(), true);
+            pacer.consume(1500);
+            test_should_be(pacer.may_send(), false);
+            test_should_be(pacer.holding_back(), true);
+            test_should_be(pacer.time_until_release().value(), uint64_t{11});
+
+            pacer.refill(10, 100.0);
+            test_should_be(pacer.may_send(), false);
+            pacer.refill(11, 100.0);
+            test_should_be(pacer.may_send(), true);
+
+            // however long the pause, no more than the burst accumulates
+            pacer.refill(1000, 100.0);
+            test_should_be(pacer.tokens(), 2000.0);
+        }
+
+        // ...though at least a millisecond's worth, as the clock runs no finer
+        {
+            Pacer pacer{2000};
+            pacer.refill(0, 5000.0);
+            pacer.consume(2000);
+            pacer.refill(100, 5000.0);
+            test_should_be(pacer.tokens(), 5000.0);
+        }
+
+        // without a rate, nothing is held back
+        {
+            Pacer pacer{2000};
+            pacer.refill(0, {});
+            pacer.consume(5000);
+            test_should_be(pacer.may_send(), true);
+            test_should_be(pacer.time_until_release().has_value(), false);
+        }
+
+        // a paced sender sends its burst, then a segment each time it has earned one
+        {
+            TCPSender sender = connected_sender(100.0);
+            test_should_be(segments_sent(sender), size_t{2});
+            test_should_be(sender.time_until_release().value(), uint64_t{1});
+
+            sender.tick(1);
+            test_should_be(segments_sent(sender), size_t{1});
+            test_should_be(sender.time_until_release().value(), uint64_t{10});
+            sender.tick(9);
+            test_should_be(segments_sent(sender), size_t{0});
+            sender.tick(1);
+            test_should_be(segments_sent(sender), size_t{1});
+
+            // acknowledgments open the window, but don't release anything sooner
+            sender.ack_received(ISN + 1 + 4 * MSS, 60000);
+            test_should_be(segments_sent(sender), size_t{0});
+        }
+
+        // retransmissions aren't paced
+        {
+            TCPSender sender = connected_sender(0.1);
+            test_should_be(segments_sent(sender), size_t{2});
+            sender.tick(1);
+            test_should_be(segments_sent(sender), size_t{1});
+            sender.tick(999);
+            test_should_be(segments_sent(sender), size_t{1});
+            test_should_be(sender.consecutive_retransmissions(), 1u);
+        }
+
+        // without a configured rate, the sender paces at the congestion controller's, and NewReno gives none
+        {
+            TCPSender sender = connected_sender({});
+            test_should_be(segments_sent(sender), size_t{10});
+            test_should_be(sender.time_until_release().has_value(), false);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#include "congestion_control.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+//! A RACK-TLP sender limited to `cwnd` bytes in flight, with its SYN acknowledged after 100 ms and
+//! `segments` segments' worth to send, which it has sent as the window allows
+static TCPSender connected_sender(const size_t cwnd, const size_t segments) {
+    TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN, make_unique<NewRenoController>(MSS, cwnd)};
+    sender.enable_rack_tlp();
+    connect(sender, segments, 100);
+    return sender;
+}
+
+int main() {
+    try {
+        // a segment sent before one that's delivered is lost once RACK's RTT (100 ms) and the
+        // reordering window (a quarter of the minimum RTT) have passed since it was sent
+        {
+            TCPSender sender = connected_sender(10 * MSS, 4);
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+
+            sender.tick(100);
+            sender.ack_received(ack(1, 1 + MSS));
+            expect_sent(sender, {});
+            sender.tick(24);
+            expect_sent(sender, {});
+            sender.tick(1);
+            expect_sent(sender, {1});
+            test_should_be(sender.stats().rack_losses, 1u);
+            test_should_be(sender.congestion_controller().cwnd(), 2 * MSS);
+        }
+
+        // one delivered within the window was only reordered
+        {
+            TCPSender sender = connected_sender(10 * MSS, 4);
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+
+            sender.tick(100);
+            sender.ack_received(ack(1, 1 + MSS));
+            sender.tick(10);
+            sender.ack_received(ack(1 + 2 * MSS));
+            sender.tick(100);
+            expect_sent(sender, {});
+            test_should_be(sender.stats().rack_losses, 0u);
+        }
+
+        // with no ack two round trips after the last send, a loss probe sends new data past the window...
+        {
+            TCPSender sender = connected_sender(4 * MSS, 10);
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+
+            sender.tick(199);
+            expect_sent(sender, {});
+            sender.tick(1);
+            expect_sent(sender, {1 + 4 * MSS});
+            test_should_be(sender.stats().tlp_probes, 1u);
+
+            // ...after which the retransmission timer takes over
+            sender.tick(999);
+            expect_sent(sender, {});
+            sender.tick(1);
+            expect_sent(sender, {1});
+            test_should_be(sender.stats().tlp_probes, 1u);
+        }
+
+        // with no new data, the probe resends the last segment; without DSACK to show it was needless,
+        // its acknowledgment reduces the window
+        {
+            TCPSender sender = connected_sender(10 * MSS, 4);
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+
+            sender.tick(200);
+            expect_sent(sender, {1 + 3 * MSS});
+            test_should_be(sender.stats().tlp_probes, 1u);
+
+            sender.tick(100);
+            sender.ack_received(ack(1 + 4 * MSS));
+            // halved, after slow start grew it by a segment for the ack
+            test_should_be(sender.congestion_controller().cwnd(), 11 * MSS / 2);
+        }
+
+        // a probe that found the tail lost lets RACK mark the segments before it; recovery resends
+        // the first at once, and then as many as the halved window has room for
+        {
+            TCPSender sender = connected_sender(4 * MSS, 5);
+            expect_sent(sender, {1, 1 + MSS, 1 + 2 * MSS, 1 + 3 * MSS});
+
+            sender.tick(200);
+            expect_sent(sender, {1 + 4 * MSS});
+            sender.tick(100);
+            sender.ack_received(ack(1, 1 + 4 * MSS));
+            expect_sent(sender, {1, 1 + MSS});
+            test_should_be(sender.stats().rack_losses, 4u);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
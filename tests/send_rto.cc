@@ -0,0 +1,113 @@
+#include "rtt_estimator.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "tcp_test_helpers.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+//! A sender whose RTO may fall to TCPConfig::RTO_MIN_LAN, with its SYN acknowledged after `rtt` ms
+static TCPSender connected_sender(const uint64_t rtt) {
+    TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN, {}, TCPConfig::RTO_MIN_LAN};
+    connect(sender, 0, rtt);
+    return sender;
+}
+
+//! Fail unless the sender retransmits after exactly `rto` more ms
+static void expect_timeout_after(TCPSender &sender, const uint64_t rto) {
+    while (not sender.segments_out().empty()) {
+        sender.segments_out().pop();
+    }
+    sender.tick(rto - 1);
+    test_should_be(sender.segments_out().size(), size_t{0});
+    sender.tick(1);
+    test_should_be(sender.segments_out().size(), size_t{1});
+    sender.segments_out().pop();
+}
+
+int main() {
+    try {
+        // the first sample sets SRTT to it and RTTVAR to half of it; RTO = SRTT + 4 * RTTVAR
+        {
+            RTTEstimator rtt{1000, 200, 60000};
+            test_should_be(rtt.rto(), uint64_t{1000});
+            rtt.sample(100);
+            test_should_be(rtt.srtt().value(), 100.0);
+            test_should_be(rtt.rttvar(), 50.0);
+            test_should_be(rtt.rto(), uint64_t{300});
+
+            // later samples are smoothed in, RTTVAR with the SRTT from before the sample
+            rtt.sample(180);
+            test_should_be(rtt.rttvar(), 0.75 * 50 + 0.25 * 80);
+            test_should_be(rtt.srtt().value(), 0.875 * 100 + 0.125 * 180);
+            test_should_be(rtt.rto(), uint64_t{340});
+            test_should_be(rtt.min_rtt().value(), uint64_t{100});
+            test_should_be(rtt.latest_rtt().value(), uint64_t{180});
+            test_should_be(rtt.samples(), 2u);
+        }
+
+        // the RTO is clamped to [rto_min, rto_max]
+        {
+            RTTEstimator rtt{1000, 200, 2000};
+            rtt.sample(10);
+            test_should_be(rtt.rto(), uint64_t{200});
+            rtt.sample(5000);
+            test_should_be(rtt.rto(), uint64_t{2000});
+        }
+
+        // by default the floor is the initial RTO
+        {
+            TCPSender sender{TCPConfig::DEFAULT_CAPACITY, 1000, ISN};
+            sender.fill_window();
+            sender.tick(10);
+            sender.ack_received(ISN + 1, 1000);
+            test_should_be(sender.stats().srtt.value(), 10.0);
+            test_should_be(sender.stats().rto, uint64_t{1000});
+        }
+
+        // on a fast path the RTO follows the round-trip time down
+        {
+            TCPSender sender = connected_sender(100);
+            test_should_be(sender.stats().rto, uint64_t{300});
+            test_should_be(sender.stats().rtt_samples, 1u);
+
+            sender.stream_in().write("abc");
+            sender.fill_window();
+            expect_timeout_after(sender, 300);
+        }
+
+        // each timeout doubles the RTO; an acknowledgment of new data takes it back to the estimate
+        {
+            TCPSender sender = connected_sender(100);
+            sender.stream_in().write("abc");
+            sender.fill_window();
+            expect_timeout_after(sender, 300);
+            test_should_be(sender.stats().rto, uint64_t{600});
+            expect_timeout_after(sender, 600);
+
+            // Karn's algorithm: the acknowledgment of a retransmitted segment gives no sample
+            sender.ack_received(ISN + 4, 1000);
+            test_should_be(sender.stats().rtt_samples, 1u);
+            test_should_be(sender.stats().rto, uint64_t{300});
+
+            sender.stream_in().write("def");
+            sender.fill_window();
+            sender.tick(20);
+            sender.ack_received(ISN + 7, 1000);
+            test_should_be(sender.stats().rtt_samples, 2u);
+            test_should_be(sender.stats().latest_rtt.value(), uint64_t{20});
+            test_should_be(sender.stats().min_rtt.value(), uint64_t{20});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
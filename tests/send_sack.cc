@@ -0,0 +1,128 @@
+#include "sender_harness.hh"
+#include "tcp_config.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+constexpr size_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+constexpr uint16_t WINDOW = 60000;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // a sender limited to `cwnd` bytes in flight, whose SYN has been acknowledged
+        const auto connected = [&](const string &name, const WrappingInt32 isn, const size_t cwnd) {
+            TCPConfig cfg;
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.initial_cwnd = cwnd;
+            TCPSenderTestHarness test{name, cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW));
+            test.execute(ExpectNoSegment{});
+            return test;
+        };
+
+        {
+            const WrappingInt32 isn(rd());
+            // the first sequence number of the `n`th segment of data
+            const auto seg = [&](const size_t n) { return isn + 1 + n * MSS; };
+
+            TCPSenderTestHarness test = connected("SACKed segments leave the pipe, making room to send", isn, 6 * MSS);
+            test.execute(WriteBytes{string(9 * MSS, 'a')});
+            for (size_t n = 0; n < 6; n++) {
+                test.execute(ExpectSegment{}.with_seqno(seg(n)).with_payload_size(MSS));
+            }
+            test.execute(ExpectNoSegment{});
+
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(1), seg(2)));
+            test.execute(ExpectSegment{}.with_seqno(seg(6)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(1), seg(3)));
+            test.execute(ExpectSegment{}.with_seqno(seg(7)));
+            test.execute(ExpectNoSegment{});
+
+            // a SACK of nothing new frees nothing; with fewer than DupThresh segments SACKed above it,
+            // the hole isn't yet taken for lost
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(1), seg(3)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{8 * MSS});
+            test.execute(ExpectCongestionWindow{6 * MSS});
+        }
+
+        {
+            const WrappingInt32 isn(rd());
+            const auto seg = [&](const size_t n) { return isn + 1 + n * MSS; };
+
+            TCPSenderTestHarness test = connected("A hole with DupThresh segments SACKed above it is resent once",
+                                                  isn, 6 * MSS);
+            test.execute(WriteBytes{string(6 * MSS, 'a')});
+            for (size_t n = 0; n < 6; n++) {
+                test.execute(ExpectSegment{}.with_seqno(seg(n)));
+            }
+
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(1), seg(2)));
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(3), seg(4)).with_sack(seg(1), seg(2)));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(3), seg(5)).with_sack(seg(1), seg(2)));
+            test.execute(ExpectSegment{}.with_seqno(seg(0)).with_payload_size(MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{3 * MSS});
+
+            // the next SACK makes the second hole lost too, in the same episode: the window isn't cut again
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(3), seg(6)).with_sack(seg(1), seg(2)));
+            test.execute(ExpectSegment{}.with_seqno(seg(2)).with_payload_size(MSS));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(3), seg(6)).with_sack(seg(1), seg(2)));
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(1), seg(2)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{3 * MSS});
+        }
+
+        {
+            const WrappingInt32 isn(rd());
+            const auto seg = [&](const size_t n) { return isn + 1 + n * MSS; };
+
+            TCPSenderTestHarness test =
+                connected("Acking the recovery point ends the episode, and a new hole begins another", isn, 12 * MSS);
+            test.execute(WriteBytes{string(24 * MSS, 'a')});
+            for (size_t n = 0; n < 12; n++) {
+                test.execute(ExpectSegment{}.with_seqno(seg(n)));
+            }
+
+            test.execute(AckReceived{isn + 1}.with_win(WINDOW).with_sack(seg(1), seg(4)));
+            test.execute(ExpectSegment{}.with_seqno(seg(0)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{6 * MSS});
+
+            // a partial ack keeps the episode going
+            test.execute(AckReceived{seg(4)}.with_win(WINDOW));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{6 * MSS});
+
+            // the recovery point acknowledged, the scoreboard starts over
+            test.execute(AckReceived{seg(12)}.with_win(WINDOW));
+            for (size_t n = 12; n < 18; n++) {
+                test.execute(ExpectSegment{}.with_seqno(seg(n)));
+            }
+            test.execute(ExpectNoSegment{});
+
+            test.execute(AckReceived{seg(12)}.with_win(WINDOW).with_sack(seg(13), seg(16)));
+            test.execute(ExpectSegment{}.with_seqno(seg(12)));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectCongestionWindow{3 * MSS});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
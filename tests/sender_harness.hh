@@ -3,6 +3,8 @@
 
 #include "byte_stream.hh"
 #include "string_conversions.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
 #include "tcp_sender.hh"
 #include "tcp_state.hh"
 #include "util.hh"
@@ -15,6 +17,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -99,6 +102,22 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+struct ExpectCongestionWindow : public SenderExpectation {
+    size_t _cwnd;
+
+    ExpectCongestionWindow(size_t cwnd) : _cwnd(cwnd) {}
+    std::string description() const { return "congestion window of " + std::to_string(_cwnd) + " bytes"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.congestion_controller().cwnd() != _cwnd) {
+            std::ostringstream ss;
+            ss << "The TCPSender's congestion window was " << sender.congestion_controller().cwnd()
+               << " bytes, but it was expected to be " << _cwnd << " bytes";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
     std::string description() const { return "no (more) segments"; }
@@ -191,11 +210,15 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    std::vector<TCPHeader::SackBlock> _sack_blocks{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        for (const auto &block : _sack_blocks) {
+            ss << " sack [" << block.left.raw_value() << ", " << block.right.raw_value() << ")";
+        }
         return ss.str();
     }
 
@@ -204,8 +227,30 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    //! SACK [left, right) too; blocks go in the order given, as the receiver would list them
+    AckReceived &with_sack(WrappingInt32 left, WrappingInt32 right) {
+        if (_sack_blocks.size() == TCPHeader::MAX_SACK_BLOCKS) {
+            throw std::runtime_error("an ack carries at most " + std::to_string(TCPHeader::MAX_SACK_BLOCKS) +
+                                     " SACK blocks");
+        }
+        _sack_blocks.push_back({left, right});
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
-        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        if (_sack_blocks.empty()) {
+            sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        } else {
+            // SACK blocks only come in a segment's options
+            TCPSegment segment;
+            TCPHeader &header = segment.header();
+            header.ack = true;
+            header.ackno = _ackno;
+            header.win = _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+            header.num_sack_blocks = _sack_blocks.size();
+            std::copy(_sack_blocks.begin(), _sack_blocks.end(), header.sack_blocks.begin());
+            sender.ack_received(segment);
+        }
         sender.fill_window();
     }
 };
@@ -394,7 +439,12 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config.send_capacity,
+                 config.rt_timeout,
+                 config.fixed_isn,
+                 CongestionController::make(config),
+                 config.rto_min,
+                 config.rto_max)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
@@ -0,0 +1,146 @@
+#include "buffer.hh"
+#include "small_vector.hh"
+#include "test_should_be.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//! Fail unless `v` holds exactly `expected`, checked through size(), indexing and iteration
+template <size_t N>
+static void expect_contents(const SmallVector<string, N> &v, const vector<string> &expected) {
+    test_should_be(v.size(), expected.size());
+    test_should_be(v.empty(), expected.empty());
+    for (size_t i = 0; i < expected.size(); i++) {
+        test_should_be(v[i] == expected[i], true);
+    }
+    if (vector<string>(v.begin(), v.end()) != expected) {
+        throw runtime_error("iterating a SmallVector gave the wrong elements");
+    }
+}
+
+int main() {
+    try {
+        // elements pushed past N spill to the heap, in order
+        {
+            SmallVector<string, 2> v;
+            expect_contents(v, {});
+            v.push_back("a");
+            v.push_back("b");
+            expect_contents(v, {"a", "b"});
+            v.push_back("c");
+            v.push_back("d");
+            expect_contents(v, {"a", "b", "c", "d"});
+            test_should_be(v.front() == "a" and v.back() == "d", true);
+        }
+
+        // pop_front() removes from the front, inline and spilled; the room it leaves is reused
+        {
+            SmallVector<string, 2> v;
+            v.push_back("a");
+            v.push_back("b");
+            v.pop_front();
+            v.push_back("c");
+            expect_contents(v, {"b", "c"});
+
+            for (const string s : {"d", "e", "f"}) {
+                v.push_back(s);
+            }
+            v.pop_front();
+            v.pop_front();
+            expect_contents(v, {"d", "e", "f"});
+            for (const string s : {"g", "h", "i", "j"}) {
+                v.push_back(s);
+            }
+            expect_contents(v, {"d", "e", "f", "g", "h", "i", "j"});
+
+            while (not v.empty()) {
+                v.pop_front();
+            }
+            expect_contents(v, {});
+            bool threw = false;
+            try {
+                v.pop_front();
+            } catch (const out_of_range &) {
+                threw = true;
+            }
+            test_should_be(threw, true);
+
+            v.push_front("z");
+            v.push_back("y");
+            expect_contents(v, {"z", "y"});
+        }
+
+        // moving takes the elements, inline or spilled, and leaves the source empty and usable
+        {
+            SmallVector<string, 2> small;
+            small.push_back("a");
+            small.push_back("b");
+            small.pop_front();
+            SmallVector<string, 2> moved{move(small)};
+            expect_contents(moved, {"b"});
+            expect_contents(small, {});
+
+            SmallVector<string, 2> spilled;
+            for (const string s : {"c", "d", "e"}) {
+                spilled.push_back(s);
+            }
+            spilled.pop_front();
+            moved = move(spilled);
+            expect_contents(moved, {"d", "e"});
+            expect_contents(spilled, {});
+            test_should_be(spilled.begin() == spilled.end(), true);
+
+            spilled.push_back("f");
+            spilled.push_back("g");
+            spilled.push_back("h");
+            expect_contents(spilled, {"f", "g", "h"});
+        }
+
+        // copies are independent
+        {
+            SmallVector<string, 2> v;
+            for (const string s : {"a", "b", "c"}) {
+                v.push_back(s);
+            }
+            SmallVector<string, 2> copy{v};
+            copy.pop_front();
+            expect_contents(v, {"a", "b", "c"});
+            expect_contents(copy, {"b", "c"});
+        }
+
+        // a moved-from BufferList or BufferViewList is empty
+        {
+            BufferList list{string("abc")};
+            list.append(string("defgh"));
+            list.append(string("ij"));
+            list.append(string("k"));
+            list.append(string("lmn"));
+            BufferList taken{move(list)};
+            test_should_be(taken.size(), size_t{14});
+            test_should_be(list.size(), size_t{0});
+            test_should_be(list.buffers().empty(), true);
+            test_should_be(list.concatenate().empty(), true);
+
+            list = move(taken);
+            test_should_be(list.concatenate() == "abcdefghijklmn", true);
+            test_should_be(taken.size(), size_t{0});
+
+            BufferViewList views{list};
+            BufferViewList taken_views{move(views)};
+            test_should_be(taken_views.size(), size_t{14});
+            test_should_be(views.size(), size_t{0});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
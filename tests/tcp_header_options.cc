@@ -0,0 +1,129 @@
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! Parse `bytes` as a TCP header, checking that the parser reports `expected`
+static TCPHeader parse_expecting(const string &bytes, const ParseResult expected) {
+    TCPHeader header;
+    NetParser p{string(bytes)};
+    if (const auto res = header.parse(p); res != expected) {
+        throw runtime_error("header parse gave " + as_string(res) + ", not " + as_string(expected));
+    }
+    return header;
+}
+
+//! Serialize `header`, parse it back, and check that the result matches
+static TCPHeader round_trip(const TCPHeader &header) {
+    const string bytes = header.serialize();
+    test_should_be(bytes.size(), header.length());
+    test_should_be(bytes.size(), TCPHeader::LENGTH + header.options_length());
+    test_should_be(bytes.size() % 4, size_t{0});
+
+    const TCPHeader parsed = parse_expecting(bytes, ParseResult::NoError);
+    test_should_be(parsed.doff * 4ul, bytes.size());
+    TCPHeader expected = header;
+    expected.doff = parsed.doff;
+    test_should_be(parsed == expected, true);
+    return parsed;
+}
+
+//! A bare header followed by `options`, with `doff` set to cover them
+static string header_with_options(const string &options) {
+    string bytes = TCPHeader{}.serialize() + options;
+    bytes.at(12) = static_cast<char>((bytes.size() / 4) << 4);
+    return bytes;
+}
+
+int main() {
+    try {
+        // the SYN options all round-trip
+        {
+            TCPHeader header;
+            header.syn = true;
+            header.mss = 1460;
+            header.window_scale = 7;
+            header.sack_permitted = true;
+            header.has_timestamps = true;
+            header.tsval = 0x12345678;
+            header.tsecr = 0;
+            const TCPHeader parsed = round_trip(header);
+            test_should_be(parsed.length(), TCPHeader::LENGTH + 24);
+        }
+
+        // SACK blocks round-trip, as many as fit beside the timestamps
+        {
+            TCPHeader header;
+            header.ack = true;
+            header.num_sack_blocks = TCPHeader::MAX_SACK_BLOCKS;
+            for (uint8_t i = 0; i < TCPHeader::MAX_SACK_BLOCKS; i++) {
+                header.sack_blocks.at(i) = {WrappingInt32{1000u * i}, WrappingInt32{1000u * i + 500}};
+            }
+            const TCPHeader all = round_trip(header);
+            test_should_be(all.num_sack_blocks, uint8_t{4});
+            test_should_be(all.length(), TCPHeader::MAX_LENGTH - 4);
+
+            header.has_timestamps = true;
+            header.tsval = 1;
+            header.tsecr = 2;
+            const TCPHeader fitted = parse_expecting(header.serialize(), ParseResult::NoError);
+            test_should_be(fitted.num_sack_blocks, uint8_t{3});
+            test_should_be(fitted.length(), TCPHeader::MAX_LENGTH);
+            test_should_be(fitted.tsval, 1u);
+            test_should_be(fitted.sack_blocks.at(2).right, WrappingInt32{2500});
+        }
+
+        // a doff larger than the options need is kept, and the rest is padding
+        {
+            TCPHeader header;
+            header.doff = 10;
+            header.mss = 536;
+            const string bytes = header.serialize();
+            test_should_be(bytes.size(), size_t{40});
+            const TCPHeader parsed = parse_expecting(bytes, ParseResult::NoError);
+            test_should_be(parsed.doff, uint8_t{10});
+            test_should_be(parsed.mss.value(), uint16_t{536});
+        }
+
+        // unknown options are skipped, and an end-of-list option stops parsing
+        {
+            const TCPHeader parsed = parse_expecting(
+                header_with_options(string{30, 4, 0, 0} + string{TCPHeader::OPT_MSS, 4, 2, 0}), ParseResult::NoError);
+            test_should_be(parsed.mss.value(), uint16_t{512});
+            const TCPHeader ended = parse_expecting(
+                header_with_options(string{TCPHeader::OPT_EOL, 0, 0, 0} + string{TCPHeader::OPT_MSS, 4, 2, 0}),
+                ParseResult::NoError);
+            test_should_be(ended.mss.has_value(), false);
+        }
+
+        // malformed options are rejected
+        {
+            const char mss = TCPHeader::OPT_MSS;
+            const char nop = TCPHeader::OPT_NOP;
+            parse_expecting(header_with_options(string{mss, 1, 0, 0}), ParseResult::BadOption);
+            parse_expecting(header_with_options(string{mss, 0, 0, 0}), ParseResult::BadOption);
+            parse_expecting(header_with_options(string{mss, 8, 0, 0}), ParseResult::BadOption);
+            parse_expecting(header_with_options(string{nop, nop, nop, mss}), ParseResult::BadOption);
+        }
+
+        // options cut off before the end the data offset claims
+        {
+            string bytes = header_with_options(string{TCPHeader::OPT_MSS, 4, 2, 0});
+            bytes.at(12) = static_cast<char>(8 << 4);
+            parse_expecting(bytes, ParseResult::PacketTooShort);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#ifndef SPONGE_TESTS_TCP_TEST_HELPERS_HH
+#define SPONGE_TESTS_TCP_TEST_HELPERS_HH
+
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "tcp_sender.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! \name Helpers for tests that connect two TCPConnections back to back
+//!@{
+
+//! Deliver `from`'s segments to `to` through their wire format, letting `edit` change each header first
+//! \returns the header of the last one, if any
+inline std::optional<TCPHeader> deliver(TCPConnection &from,
+                                        TCPConnection &to,
+                                        const std::function<void(TCPHeader &)> &edit = {}) {
+    std::optional<TCPHeader> last{};
+    while (not from.segments_out().empty()) {
+        TCPSegment parsed;
+        if (parsed.parse(from.segments_out().front().serialize().concatenate()) != ParseResult::NoError) {
+            throw std::runtime_error("failed to parse a serialized segment");
+        }
+        from.segments_out().pop();
+        if (edit) {
+            edit(parsed.header());
+        }
+        last = parsed.header();
+        to.segment_received(parsed);
+    }
+    return last;
+}
+
+//! \returns the oldest of `conn`'s outbound segments, dequeuing it
+inline TCPSegment take_segment(TCPConnection &conn) {
+    test_should_be(conn.segments_out().empty(), false);
+    TCPSegment seg = conn.segments_out().front();
+    conn.segments_out().pop();
+    return seg;
+}
+
+//! Connect `x` to `y`
+inline void handshake(TCPConnection &x, TCPConnection &y) {
+    x.connect();
+    deliver(x, y);
+    deliver(y, x);
+    deliver(x, y);
+}
+
+//! Connect `x` to `y`, then fill `y`'s receive buffer of `capacity` bytes
+inline void handshake_and_fill(TCPConnection &x, TCPConnection &y, const size_t capacity) {
+    handshake(x, y);
+    x.write(std::string(capacity, 'x'));
+    deliver(x, y);
+    test_should_be(deliver(y, x).value().win, uint16_t{0});
+}
+//!@}
+
+//! \name Helpers for tests that drive a TCPSender by hand
+//!@{
+
+//! The ISN of the senders under test
+const WrappingInt32 ISN{0};
+
+//! An acknowledgment of everything before `ackno` (absolute), and of [`sacked`, `sacked` + MSS) if given
+inline TCPSegment ack(const uint64_t ackno, const std::optional<uint64_t> sacked = {}) {
+    TCPSegment segment;
+    TCPHeader &header = segment.header();
+    header.ack = true;
+    header.ackno = ISN + ackno;
+    header.win = 60000;
+    if (sacked.has_value()) {
+        header.num_sack_blocks = 1;
+        header.sack_blocks[0] = {ISN + sacked.value(), ISN + sacked.value() + TCPConfig::MAX_PAYLOAD_SIZE};
+    }
+    return segment;
+}
+
+//! Have `sender` send its SYN and get it acknowledged `rtt` ms later, then give it `segments` segments' worth
+//! to send, which it sends as the window allows
+inline void connect(TCPSender &sender, const size_t segments, const uint64_t rtt = 0) {
+    sender.fill_window();
+    sender.segments_out().pop();
+    sender.tick(rtt);
+    sender.ack_received(ack(1));
+    sender.stream_in().write(std::string(segments * TCPConfig::MAX_PAYLOAD_SIZE, 'a'));
+    sender.fill_window();
+}
+
+//! Fail unless the sender has sent segments beginning at exactly `seqnos` (absolute), in order
+inline void expect_sent(TCPSender &sender, const std::vector<uint64_t> &seqnos) {
+    std::vector<uint64_t> sent;
+    while (not sender.segments_out().empty()) {
+        sent.push_back(sender.segments_out().front().header().seqno - ISN);
+        sender.segments_out().pop();
+    }
+    if (sent != seqnos) {
+        std::string message = "the sender should have sent segments at";
+        for (const auto seqno : seqnos) {
+            message += " " + std::to_string(seqno);
+        }
+        message += ", but sent them at";
+        for (const auto seqno : sent) {
+            message += " " + std::to_string(seqno);
+        }
+        throw std::runtime_error(message);
+    }
+}
+//!@}
+
+#endif  // SPONGE_TESTS_TCP_TEST_HELPERS_HH
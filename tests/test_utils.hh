@@ -39,4 +39,14 @@ inline bool compare_tcp_headers(const TCPHeader &h1, const TCPHeader &h2) {
     return compare_tcp_headers_nolen(h1, h2) && h1.doff == h2.doff;
 }
 
+//! Remove the options (and any other extension) from a header, so it serializes to the minimum length
+inline void strip_tcp_options(TCPHeader &h) {
+    h.doff = TCPHeader::LENGTH / 4;
+    h.mss.reset();
+    h.window_scale.reset();
+    h.has_timestamps = false;
+    h.sack_permitted = false;
+    h.num_sack_blocks = 0;
+}
+
 #endif  // SPONGE_TESTS_TEST_UTILS_HH